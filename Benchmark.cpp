@@ -0,0 +1,988 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "alloc.h"
+#include "map.h"
+#include "unordered_map.h"
+#include "rb_tree.h"
+#include "arena.h"
+#include "set.h"
+#include "unordered_set.h"
+#include "vector.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "mmap_vector.h"
+#include "dynamic_bitset.h"
+#include "work_stealing_deque.h"
+#include "circular_buffer.h"
+#include "concurrent_queue.h"
+#include "queue.h"
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+#include "list.h"
+#include "deque.h"
+#include <deque>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+//计时工具，返回f运行的毫秒数
+template<class F>
+double time_ms(F f) {
+    auto begin = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+//简单的线性同余随机数，保证各个分配器看到相同的请求序列
+struct lcg {
+    unsigned long long state;
+    explicit lcg(unsigned long long seed) : state(seed) {}
+    size_t next() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<size_t>(state >> 33);
+    }
+};
+
+/*
+ * 多线程分配吞吐：每个线程维护256个槽，不断释放旧区块并分配8~128字节的新区块
+ */
+struct std_malloc_policy {
+    static void* allocate(size_t n) { return malloc(n); }
+    static void deallocate(void* p, size_t) { free(p); }
+};
+struct stl_alloc_policy {
+    static void* allocate(size_t n) { return STL::alloc::allocate(n); }
+    static void deallocate(void* p, size_t n) { STL::alloc::deallocate(p, n); }
+};
+
+template<class Policy>
+void alloc_worker(size_t ops, unsigned long long seed) {
+    const size_t slots = 256;
+    void* ptr[slots] = {};
+    size_t sz[slots] = {};
+    lcg rng(seed);
+    for (size_t i = 0; i < ops; ++ i) {
+        size_t k = i % slots;
+        if (ptr[k]) Policy::deallocate(ptr[k], sz[k]);
+        sz[k] = (rng.next() % 16 + 1) * 8;
+        ptr[k] = Policy::allocate(sz[k]);
+        *static_cast<char*>(ptr[k]) = static_cast<char>(i);
+    }
+    for (size_t k = 0; k < slots; ++ k) {
+        if (ptr[k]) Policy::deallocate(ptr[k], sz[k]);
+    }
+}
+
+template<class Policy>
+double alloc_throughput(size_t nthreads, size_t ops_per_thread) {
+    double ms = time_ms([&] {
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < nthreads; ++ t)
+            workers.emplace_back(alloc_worker<Policy>, ops_per_thread, t + 1);
+        for (auto& w : workers) w.join();
+    });
+    return nthreads * ops_per_thread / ms / 1000.0; // Mops/s
+}
+
+void allocThreadBench() {
+    const size_t ops = 500000;
+    std::cout << "alloc vs malloc, multi-thread throughput (Mops/s)" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "STL::alloc" << std::setw(14) << "malloc" << std::endl;
+    for (size_t n = 1; n <= 64; n *= 2) {
+        double pool = alloc_throughput<stl_alloc_policy>(n, ops);
+        double sys = alloc_throughput<std_malloc_policy>(n, ops);
+        std::cout << std::setw(8) << n << std::setw(14) << pool << std::setw(14) << sys << std::endl;
+    }
+}
+
+/*
+ * map/unordered_map插入删除交替：节点携带64~512字节的值，超过128字节的节点现在也走内存池
+ * 可用-DMY_TINY_STL_ALLOC_MAX_BYTES=128编译得到旧的分级作对比
+ */
+template<size_t N>
+struct payload {
+    char data[N];
+};
+
+template<class Map, size_t N>
+double map_churn(size_t live, size_t ops) {
+    Map m;
+    lcg rng(42);
+    payload<N> value = {};
+    return time_ms([&] {
+        for (size_t i = 0; i < live; ++ i)
+            m.insert(std::make_pair(int(rng.next() % (live * 2)), value));
+        for (size_t i = 0; i < ops; ++ i) {
+            m.erase(int(rng.next() % (live * 2)));
+            m.insert(std::make_pair(int(rng.next() % (live * 2)), value));
+        }
+    });
+}
+
+template<size_t N>
+void map_churn_row(size_t live, size_t ops) {
+    std::cout << std::setw(8) << N
+              << std::setw(14) << map_churn<STL::map<int, payload<N>>, N>(live, ops)
+              << std::setw(14) << map_churn<std::map<int, payload<N>>, N>(live, ops)
+              << std::setw(18) << map_churn<STL::unordered_map<int, payload<N>>, N>(live, ops)
+              << std::setw(18) << map_churn<std::unordered_map<int, payload<N>>, N>(live, ops)
+              << std::endl;
+}
+
+void mapChurnBench() {
+    const size_t live = 20000, ops = 200000;
+    std::cout << "map/unordered_map insert+erase churn, pool max " << MY_TINY_STL_ALLOC_MAX_BYTES << " bytes (ms)" << std::endl;
+    std::cout << std::setw(8) << "value" << std::setw(14) << "STL::map" << std::setw(14) << "std::map"
+              << std::setw(18) << "STL::unordered" << std::setw(18) << "std::unordered" << std::endl;
+    map_churn_row<64>(live, ops);
+    map_churn_row<128>(live, ops);
+    map_churn_row<256>(live, ops);
+    map_churn_row<512>(live, ops);
+}
+
+/*
+ * 构建一棵1M节点的rb_tree再整体丢弃：默认alloc逐个归还节点，arena上的int节点析构与归还都是空操作，
+ * clear不遍历整棵树，最后release一次性释放
+ */
+template<class Alloc>
+void rb_tree_build_drop(size_t n, double& build, double& drop, STL::monotonic_arena* arena) {
+    typedef STL::rb_tree<int, STL::less<int>, Alloc> tree_type;
+    tree_type* tree = nullptr;
+    lcg rng(7);
+    build = time_ms([&] {
+        tree = new tree_type();
+        for (size_t i = 0; i < n; ++ i)
+            tree->emplace_multi(int(rng.next()));
+    });
+    drop = time_ms([&] {
+        delete tree;
+        if (arena) arena->release();
+    });
+}
+
+void arenaBench() {
+    const size_t n = 1000000;
+    std::cout << "rb_tree build + drop, " << n << " nodes (ms)" << std::endl;
+    std::cout << std::setw(12) << "allocator" << std::setw(12) << "build" << std::setw(12) << "drop" << std::endl;
+    for (int round = 0; round < 2; ++ round) {
+        double build, drop;
+        rb_tree_build_drop<STL::allocator<int>>(n, build, drop, nullptr);
+        std::cout << std::setw(12) << "alloc" << std::setw(12) << build << std::setw(12) << drop << std::endl;
+        STL::monotonic_arena arena;
+        STL::arena_scope scope(arena);
+        rb_tree_build_drop<STL::arena_allocator<int>>(n, build, drop, &arena);
+        std::cout << std::setw(12) << "arena" << std::setw(12) << build << std::setw(12) << drop << std::endl;
+    }
+}
+
+/*
+ * 用perf_event_open统计一段代码的dTLB读缺失次数，不支持或没有权限时valid()为false
+ */
+struct dtlb_counter {
+    int fd;
+    dtlb_counter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~dtlb_counter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    bool valid() const { return fd >= 0; }
+    void start() {
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+    long long stop() {
+        long long count = -1;
+#ifdef __linux__
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) count = -1;
+        }
+#endif
+        return count;
+    }
+};
+
+/*
+ * 大容器上的随机查找：节点散布在几百MB内存里，指针跳转主要受TLB缺失限制
+ * 分别在普通页和透明大页下构建rb_tree与hashtable，统计查找耗时和dTLB缺失
+ */
+template<class Container, class Find>
+void huge_page_find_row(const char* name, bool huge, size_t n, Find find) {
+    STL::alloc::flush_thread_cache();
+    STL::alloc::trim(); //让上一轮的chunk还给系统，这一轮的节点全部来自新chunk
+    STL::alloc::set_huge_pages(huge);
+    Container* c = new Container();
+    lcg rng(11);
+    for (size_t i = 0; i < n; ++ i) c->insert(long(rng.next() % (n * 2)));
+    size_t huge_bytes = STL::alloc::get_stats().huge_page_bytes;
+
+    dtlb_counter counter;
+    size_t hits = 0;
+    lcg probe(13);
+    counter.start();
+    double ms = time_ms([&] {
+        for (size_t i = 0; i < n; ++ i) hits += find(*c, long(probe.next() % (n * 2)));
+    });
+    long long misses = counter.stop();
+    std::cout << std::setw(10) << name << std::setw(8) << (huge ? "huge" : "4K") << std::setw(12) << ms;
+    if (misses >= 0) std::cout << std::setw(16) << misses;
+    else std::cout << std::setw(16) << "n/a";
+    std::cout << std::setw(14) << (huge_bytes >> 20) << std::setw(10) << hits << std::endl;
+    delete c;
+}
+
+struct rb_tree_find {
+    size_t operator()(STL::multiset<long>& s, long key) const { return s.count(key); }
+};
+struct hashtable_find {
+    size_t operator()(STL::unordered_set<long>& s, long key) const { return s.count(key); }
+};
+
+void hugePageBench() {
+    const size_t n = 1 << 21;
+    std::cout << "random find on " << n << " nodes, 4K pages vs transparent huge pages" << std::endl;
+    std::cout << std::setw(10) << "container" << std::setw(8) << "pages" << std::setw(12) << "find ms"
+              << std::setw(16) << "dTLB misses" << std::setw(14) << "huge MB" << std::setw(10) << "hits" << std::endl;
+    for (int huge = 0; huge < 2; ++ huge) {
+        huge_page_find_row<STL::multiset<long>>("rb_tree", huge != 0, n, rb_tree_find());
+        huge_page_find_row<STL::unordered_set<long>>("hashtable", huge != 0, n, hashtable_find());
+    }
+    STL::alloc::set_huge_pages(false);
+}
+
+/*
+ * vector扩容与头部删除：可平凡复制的POD和选择加入is_trivially_relocatable的句柄按字节搬移，
+ * 未加入的同样句柄逐个移动构造再析构
+ */
+struct pod4 {
+    int a, b, c, d;
+    pod4(int v = 0) : a(v), b(v), c(v), d(v) {}
+};
+
+template<bool Relocatable>
+struct bench_handle {
+    int* p;
+    bench_handle(int v = 0) : p(new int(v)) {}
+    bench_handle(bench_handle&& rhs) noexcept : p(rhs.p) { rhs.p = nullptr; }
+    bench_handle& operator=(bench_handle&& rhs) noexcept { std::swap(p, rhs.p); return *this; }
+    ~bench_handle() { delete p; }
+};
+namespace STL {
+    template<> struct is_trivially_relocatable<bench_handle<true> > : std::true_type {};
+}
+
+template<class Vector>
+void vector_relocate_row(const char* name, size_t n, size_t erases) {
+    double grow = time_ms([&] {
+        Vector v;
+        for (size_t i = 0; i < n; ++ i) v.emplace_back(int(i));
+    });
+    Vector v;
+    for (size_t i = 0; i < 20000; ++ i) v.emplace_back(int(i));
+    double erase = time_ms([&] {
+        for (size_t i = 0; i < erases; ++ i) {
+            v.erase(v.begin());
+            v.emplace_back(int(i));
+        }
+    });
+    std::cout << std::setw(22) << name << std::setw(12) << grow << std::setw(12) << erase << std::endl;
+}
+
+void vectorRelocateBench() {
+    const size_t n = 1 << 22, erases = 20000;
+    std::cout << "vector growth (" << n << " emplace_back) and front erase on 20000 elements (ms)" << std::endl;
+    std::cout << std::setw(22) << "element" << std::setw(12) << "grow" << std::setw(12) << "erase" << std::endl;
+    vector_relocate_row<STL::vector<pod4> >("STL pod", n, erases);
+    vector_relocate_row<std::vector<pod4> >("std pod", n, erases);
+    vector_relocate_row<STL::vector<bench_handle<true> > >("STL relocatable", n, erases);
+    vector_relocate_row<STL::vector<bench_handle<false> > >("STL handle", n, erases);
+    vector_relocate_row<std::vector<bench_handle<false> > >("std handle", n, erases);
+}
+
+/*
+ * 预先开出一块缓冲区再整体覆盖写入：resize先把新元素置零，resize_default_init不写内存，
+ * 时间包含随后的一遍写入(缺页也算在其中)
+ */
+template<class Resize>
+double presize_row(size_t n, Resize resize) {
+    return time_ms([&] {
+        STL::vector<unsigned> v;
+        resize(v, n);
+        unsigned* p = v.data();
+        for (size_t i = 0; i < n; ++ i) p[i] = unsigned(i * 2654435761u);
+        if (p[n / 2] == 1) std::cout << "";
+    });
+}
+
+void vectorPresizeBench() {
+    const size_t n = size_t(1) << 27; //512MB
+    std::cout << "vector<unsigned> presize " << n << " elements then overwrite (ms)" << std::endl;
+    double fill = presize_row(n, [](STL::vector<unsigned>& v, size_t n) { v.resize(n); });
+    double raw = presize_row(n, [](STL::vector<unsigned>& v, size_t n) { v.resize_default_init(n); });
+    std::cout << std::setw(22) << "resize" << std::setw(12) << fill << std::endl;
+    std::cout << std::setw(22) << "resize_default_init" << std::setw(12) << raw << std::endl;
+}
+
+/*
+ * 短生命周期的小vector：反复构建k个元素的容器再丢弃，统计每个容器的分配次数和平均耗时
+ * small_vector<int, 16>在16个元素以内完全不分配
+ */
+size_t counted_allocs = 0;
+template<class T>
+struct counting_allocator : STL::allocator<T> {
+    template<class U>
+    struct rebind {
+        typedef counting_allocator<U> other;
+    };
+    counting_allocator() = default;
+    template<class U>
+    counting_allocator(const counting_allocator<U>&) {}
+    static T* allocate(size_t n) { ++ counted_allocs; return STL::allocator<T>::allocate(n); }
+    static T* reallocate(T* p, size_t old_n, size_t new_n) { ++ counted_allocs; return STL::allocator<T>::reallocate(p, old_n, new_n); }
+};
+
+template<class Vector>
+void small_vector_row(const char* name, size_t k, size_t rounds) {
+    counted_allocs = 0;
+    unsigned long long sink = 0;
+    double ms = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++ r) {
+            Vector v;
+            for (size_t i = 0; i < k; ++ i) v.push_back(int(i + r));
+            sink += v.empty() ? 0 : v.back();
+        }
+    });
+    if (sink == 1) std::cout << "";
+    std::cout << std::setw(22) << name << std::setw(6) << k << std::setw(12) << double(counted_allocs) / rounds
+              << std::setw(12) << ms * 1e6 / rounds << std::endl;
+}
+
+void smallVectorBench() {
+    const size_t rounds = 1000000;
+    std::cout << "build and drop a k-element vector (" << rounds << " rounds): allocations and ns per container" << std::endl;
+    std::cout << std::setw(22) << "container" << std::setw(6) << "k" << std::setw(12) << "allocs" << std::setw(12) << "ns" << std::endl;
+    const size_t sizes[] = {1, 4, 8, 16, 32};
+    for (size_t k : sizes) {
+        small_vector_row<STL::vector<int, counting_allocator<int> > >("STL vector", k, rounds);
+        small_vector_row<STL::small_vector<int, 16, counting_allocator<int> > >("STL small_vector<16>", k, rounds);
+        small_vector_row<std::vector<int, counting_allocator<int> > >("std vector", k, rounds);
+    }
+}
+
+/*
+ * vector扩容策略：push_back n个int，统计扩容(分配+reallocate)次数、最终容量多出的比例和每次push_back的耗时
+ */
+template<class Vector>
+void growth_row(const char* name, size_t n, size_t rounds) {
+    counted_allocs = 0;
+    size_t cap = 0;
+    double ms = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++ r) {
+            Vector v;
+            for (size_t i = 0; i < n; ++ i) v.push_back(int(i));
+            cap = v.capacity();
+        }
+    });
+    std::cout << std::setw(22) << name << std::setw(10) << n << std::setw(10) << counted_allocs / rounds
+              << std::setw(11) << std::fixed << std::setprecision(1) << 100.0 * (cap - n) / n << "%"
+              << std::setw(10) << std::setprecision(2) << ms * 1e6 / (double(n) * rounds) << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+}
+
+void vectorGrowthBench() {
+    std::cout << "vector growth policies: push_back n ints, reallocations, unused capacity, ns per push_back" << std::endl;
+    std::cout << std::setw(22) << "policy" << std::setw(10) << "n" << std::setw(10) << "reallocs"
+              << std::setw(12) << "unused" << std::setw(10) << "ns" << std::endl;
+    const size_t sizes[] = {10, 1000, 100000, 3000000};
+    for (size_t n : sizes) {
+        size_t rounds = 30000000 / n;
+        growth_row<STL::vector<int, counting_allocator<int>, STL::vector_growth_double> >("2x", n, rounds);
+        growth_row<STL::vector<int, counting_allocator<int>, STL::vector_growth_golden> >("1.5x", n, rounds);
+        growth_row<STL::vector<int, counting_allocator<int>, STL::vector_growth_size_class<> > >("2x size class", n, rounds);
+        growth_row<STL::vector<int, counting_allocator<int>,
+                STL::vector_growth_size_class<STL::vector_growth_golden> > >("1.5x size class", n, rounds);
+        growth_row<std::vector<int, counting_allocator<int> > >("std vector", n, rounds);
+    }
+}
+
+/*
+ * 从其他容器构建vector：逐个push_back与append_range对比
+ * 随机访问的来源只分配一次，vector来源的int整段memmove；节点式容器的来源逐个追加，与push_back持平
+ */
+template<class Source>
+void vector_range_row(const char* name, Source& src, size_t rounds) {
+    unsigned long long sink = 0;
+    double each = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++ r) {
+            STL::vector<int> v;
+            for (auto it = src.begin(); it != src.end(); ++ it) v.push_back(*it);
+            sink += v.size();
+        }
+    });
+    double range = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++ r) {
+            STL::vector<int> v;
+            v.append_range(src);
+            sink += v.size();
+        }
+    });
+    if (sink == 1) std::cout << "";
+    std::cout << std::setw(22) << name << std::setw(12) << each << std::setw(12) << range << std::endl;
+}
+
+void vectorRangeBench() {
+    const size_t n = 100000, rounds = 200;
+    STL::vector<int> src_vector;
+    STL::list<int> src_list;
+    STL::deque<int> src_deque;
+    STL::unordered_set<int> src_set;
+    for (size_t i = 0; i < n; ++ i) {
+        src_vector.push_back(int(i));
+        src_list.push_back(int(i));
+        src_deque.push_back(int(i));
+        src_set.insert(int(i));
+    }
+    std::cout << "build a vector<int> from " << n << " elements x" << rounds << " (ms)" << std::endl;
+    std::cout << std::setw(22) << "source" << std::setw(12) << "push_back" << std::setw(12) << "range" << std::endl;
+    vector_range_row("vector", src_vector, rounds);
+    vector_range_row("list", src_list, rounds);
+    vector_range_row("deque", src_deque, rounds);
+    vector_range_row("unordered_set", src_set, rounds);
+}
+
+/*
+ * 列扫描：56字节的记录只读price和qty两个字段求和
+ * 按行存储(vector<record>)每条缓存行只用到12字节，按列存储(soa_vector)读到的每个字节都有用
+ */
+struct record {
+    double price;
+    int qty;
+    int flags;
+    long long id;
+    double open, high, low, close;
+};
+
+void soaScanBench() {
+    const size_t n = size_t(1) << 22, rounds = 10;
+    STL::vector<record> aos;
+    STL::soa_vector<double, int, int, long long, double, double, double, double> soa;
+    aos.reserve(n);
+    soa.reserve(n);
+    for (size_t i = 0; i < n; ++ i) {
+        aos.push_back(record{i * 0.25, int(i % 100), 0, (long long)i, 1, 2, 3, 4});
+        soa.push_back(i * 0.25, int(i % 100), 0, (long long)i, 1, 2, 3, 4);
+    }
+    double aos_sum = 0, soa_sum = 0;
+    double aos_ms = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++ r) {
+            const record* p = aos.data();
+            for (size_t i = 0; i < n; ++ i) aos_sum += p[i].price * p[i].qty;
+        }
+    });
+    double soa_ms = time_ms([&] {
+        for (size_t r = 0; r < rounds; ++ r) {
+            const double* price = soa.data<0>();
+            const int* qty = soa.data<1>();
+            for (size_t i = 0; i < n; ++ i) soa_sum += price[i] * qty[i];
+        }
+    });
+    std::cout << "column scan sum(price * qty) over " << n << " 56-byte records x" << rounds << " (ms)" << std::endl;
+    std::cout << std::setw(22) << "vector<record>" << std::setw(12) << aos_ms << std::endl;
+    std::cout << std::setw(22) << "soa_vector" << std::setw(12) << soa_ms
+              << (aos_sum == soa_sum ? "" : "  (mismatch)") << std::endl;
+}
+
+/*
+ * 启动时载入一个记录文件并扫描一遍：fread后逐个push_back进vector与直接打开mmap_vector对比
+ * 文件已在页缓存中，差别来自复制和vector的扩容；峰值内存方面mmap_vector不额外占用匿名内存
+ */
+struct tick {
+    long long time;
+    double price;
+};
+
+void mmapLoadBench() {
+    const char* path = "/tmp/mytinystl_mmap_bench.bin";
+    const size_t n = size_t(1) << 23; //128MB
+    {
+        STL::mmap_vector<tick> out(path);
+        out.reserve(n);
+        for (size_t i = 0; i < n; ++ i) out.push_back(tick{(long long)i, i * 0.5});
+    }
+    double vector_sum = 0, mmap_sum = 0;
+    double vector_ms = time_ms([&] {
+        STL::vector<tick> v;
+        FILE* f = fopen(path, "rb");
+        tick buf[4096];
+        size_t got;
+        while ((got = fread(buf, sizeof(tick), 4096, f)) != 0)
+            for (size_t i = 0; i < got; ++ i) v.push_back(buf[i]);
+        fclose(f);
+        for (size_t i = 0; i < v.size(); ++ i) vector_sum += v[i].price;
+    });
+    double mmap_ms = time_ms([&] {
+        STL::mmap_vector<tick> v(path, STL::mmap_vector<tick>::read_only);
+        for (size_t i = 0; i < v.size(); ++ i) mmap_sum += v[i].price;
+    });
+    std::remove(path);
+    std::cout << "load and scan " << n << " 16-byte records from a file (ms)" << std::endl;
+    std::cout << std::setw(22) << "fread + vector" << std::setw(12) << vector_ms << std::endl;
+    std::cout << std::setw(22) << "mmap_vector" << std::setw(12) << mmap_ms
+              << (vector_sum == mmap_sum ? "" : "  (mismatch)") << std::endl;
+}
+
+/*
+ * 大规模id集合：标记随机id(visited集合)、两个集合求交后计数、按顺序遍历集合中的id
+ * 字节数组每个标记占8倍空间；std::vector<bool>按位存储但求交和遍历只能逐位进行；
+ * dynamic_bitset按字与、popcount计数、ctz跳过空位
+ */
+template <class Set, class Mark, class Intersect, class Scan>
+void bitset_row(const char* name, size_t n, Mark mark, Intersect intersect, Scan scan) {
+    Set a(n), b(n);
+    size_t hits = 0, inter = 0, scanned = 0;
+    double mark_ms = time_ms([&] {
+        lcg ra(1), rb(2);
+        for (size_t i = 0; i < n / 8; ++ i) {
+            hits += mark(a, ra.next() % n);
+            mark(b, rb.next() % n);
+        }
+    });
+    double and_ms = time_ms([&] { inter = intersect(a, b); });
+    double scan_ms = time_ms([&] { scanned = scan(a); });
+    std::cout << std::setw(22) << name << std::setw(12) << mark_ms << std::setw(12) << and_ms
+              << std::setw(12) << scan_ms << "   (" << hits << " " << inter << " " << scanned << ")" << std::endl;
+}
+
+void dynamicBitsetBench() {
+    const size_t n = size_t(1) << 27;
+    std::cout << "id set over " << n << " ids, " << n / 8 << " random marks per set (ms)" << std::endl;
+    std::cout << std::setw(22) << "" << std::setw(12) << "mark" << std::setw(12) << "and+count"
+              << std::setw(12) << "scan" << std::endl;
+    typedef std::vector<unsigned char> bytes;
+    bitset_row<bytes>("vector<unsigned char>", n,
+        [](bytes& s, size_t i) { bool old = s[i] != 0; s[i] = 1; return old; },
+        [](bytes& a, const bytes& b) {
+            size_t c = 0;
+            for (size_t i = 0; i < a.size(); ++ i) c += (a[i] &= b[i]);
+            return c;
+        },
+        [](const bytes& s) {
+            size_t c = 0;
+            for (size_t i = 0; i < s.size(); ++ i) if (s[i]) c += i & 1;
+            return c;
+        });
+    typedef std::vector<bool> bools;
+    bitset_row<bools>("std::vector<bool>", n,
+        [](bools& s, size_t i) { bool old = s[i]; s[i] = true; return old; },
+        [](bools& a, const bools& b) {
+            size_t c = 0;
+            for (size_t i = 0; i < a.size(); ++ i) c += (a[i] = a[i] && b[i]);
+            return c;
+        },
+        [](const bools& s) {
+            size_t c = 0;
+            for (size_t i = 0; i < s.size(); ++ i) if (s[i]) c += i & 1;
+            return c;
+        });
+    typedef STL::dynamic_bitset<> bits;
+    bitset_row<bits>("dynamic_bitset", n,
+        [](bits& s, size_t i) { return s.test_set(i); },
+        [](bits& a, const bits& b) { return (a &= b).count(); },
+        [](const bits& s) {
+            size_t c = 0;
+            for (size_t i = s.find_first(); i != bits::npos; i = s.find_next(i)) c += i & 1;
+            return c;
+        });
+}
+
+/*
+ * fork-join调度：并行fib任务树，每个任务要么拆成两个子任务压入自己的队列，要么在阈值以下串行计算
+ * 每个工作线程一个队列，自己从底部取，空了就随机挑一个队列从顶部偷；只替换队列实现，调度逻辑相同
+ * 加锁的STL::deque每次push/pop都要拿锁，Chase-Lev队列的push/pop只在抢最后一个元素时才有CAS
+ */
+template <class T>
+struct locked_deque {
+    STL::deque<T> q;
+    std::mutex m;
+
+    void push(const T& val) {
+        std::lock_guard<std::mutex> lock(m);
+        q.push_back(val);
+    }
+    bool pop(T& out) {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.empty()) return false;
+        out = q.back();
+        q.pop_back();
+        return true;
+    }
+    bool steal(T& out) {
+        std::lock_guard<std::mutex> lock(m);
+        if (q.empty()) return false;
+        out = q.front();
+        q.pop_front();
+        return true;
+    }
+};
+
+long long serial_fib(int n) { return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2); }
+
+template <class Deque>
+void fork_join_row(const char* name, unsigned threads, int n, int cutoff) {
+    //work_stealing_deque的top/bottom按64字节对齐，C++11的new[]不保证过对齐，改用按alignof分配的STL::allocator
+    typedef STL::allocator<Deque> deque_alloc;
+    Deque* queues = deque_alloc::allocate(threads);
+    for (unsigned i = 0; i < threads; ++ i) deque_alloc::construct(queues + i);
+    std::atomic<long long> pending(1), result(0), steals(0);
+    queues[0].push(n);
+    double ms = time_ms([&] {
+        std::vector<std::thread> workers;
+        for (unsigned id = 0; id < threads; ++ id) {
+            workers.emplace_back([&, id] {
+                lcg rng(id + 1);
+                long long stolen = 0, sum = 0;
+                int task;
+                while (pending.load(std::memory_order_acquire) != 0) {
+                    if (!queues[id].pop(task)) {
+                        if (!queues[rng.next() % threads].steal(task)) {
+                            std::this_thread::yield();
+                            continue;
+                        }
+                        ++ stolen;
+                    }
+                    if (task < cutoff) sum += serial_fib(task);
+                    else {
+                        pending.fetch_add(2, std::memory_order_relaxed);
+                        queues[id].push(task - 1);
+                        queues[id].push(task - 2);
+                    }
+                    pending.fetch_sub(1, std::memory_order_acq_rel);
+                }
+                result += sum;
+                steals += stolen;
+            });
+        }
+        for (auto &w : workers) w.join();
+    });
+    for (unsigned i = 0; i < threads; ++ i) deque_alloc::destroy(queues + i);
+    deque_alloc::deallocate(queues, threads);
+    std::cout << std::setw(22) << name << std::setw(12) << ms << "   (fib " << result.load()
+              << ", " << steals.load() << " steals)" << std::endl;
+}
+
+void workStealingBench() {
+    const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+    const int n = 32, cutoff = 4;
+    std::cout << "fork-join fib(" << n << "), serial below " << cutoff << ", " << threads << " threads (ms)" << std::endl;
+    fork_join_row<locked_deque<int>>("mutex + STL::deque", threads, n, cutoff);
+    fork_join_row<STL::work_stealing_deque<int>>("work_stealing_deque", threads, n, cutoff);
+}
+
+/*
+ * 稳定状态的队列：先放入depth个元素，之后每次pop_front一个再push_back一个，统计每次操作向配置器申请的次数和耗时
+ * 缓存区走到头时pop_front_aux释放一个、push_back_aux申请一个，备用缓存区把这一对抵消掉
+ * 64字节的元素在512字节的缓存区里只放8个，换成4 KiB的缓存区跨缓存区的次数少8倍
+ */
+struct payload64 {
+    long long v[8];
+    payload64(long long x = 0) { v[0] = x; }
+};
+
+template<class Deque>
+void deque_fifo_row(const char* name, size_t depth, size_t ops) {
+    Deque d;
+    for (size_t i = 0; i < depth; ++ i) d.push_back(typename Deque::value_type(i));
+    counted_allocs = 0;
+    long long sink = 0;
+    double ms = time_ms([&] {
+        for (size_t i = 0; i < ops; ++ i) {
+            sink += d.front().v[0];
+            d.pop_front();
+            d.push_back(typename Deque::value_type(i));
+        }
+    });
+    std::cout << std::setw(22) << name << std::setw(14) << double(counted_allocs) / ops
+              << std::setw(12) << ms * 1e6 / ops << (sink == 0 ? "  (sink)" : "") << std::endl;
+}
+
+void dequeFifoBench() {
+    const size_t depth = 10000, ops = 20000000;
+    typedef counting_allocator<payload64> alloc64;
+    std::cout << "steady-state FIFO of " << depth << " 64-byte elements, " << ops << " pop_front + push_back" << std::endl;
+    std::cout << std::setw(22) << "" << std::setw(14) << "allocs/op" << std::setw(12) << "ns/op" << std::endl;
+    deque_fifo_row<std::deque<payload64, alloc64> >("std deque", depth, ops);
+    deque_fifo_row<STL::deque<payload64, alloc64> >("STL deque 512 B", depth, ops);
+    deque_fifo_row<STL::deque<payload64, alloc64, STL::deque_block_size(4096, sizeof(payload64))> >(
+            "STL deque 4 KiB", depth, ops);
+}
+
+/*
+ * deque上的算法：逐元素版本每次++都要检查是否走到缓存区末尾并set_node，
+ * 分段版本对每个缓存区跑一对指针上的循环，可平凡复制的元素复制时直接memmove
+ * 逐元素一列调用的是分段派发之前的实现(std::false_type分支)
+ */
+template<class F1, class F2>
+void segment_row(const char* name, size_t rounds, F1 element, F2 segmented) {
+    double element_ms = time_ms([&] { for (size_t r = 0; r < rounds; ++ r) element(); });
+    double segmented_ms = time_ms([&] { for (size_t r = 0; r < rounds; ++ r) segmented(); });
+    std::cout << std::setw(22) << name << std::setw(12) << element_ms << std::setw(12) << segmented_ms << std::endl;
+}
+
+void dequeSegmentBench() {
+    typedef STL::deque<int> deque_int;
+    const size_t n = size_t(1) << 16, rounds = 2000;
+    deque_int d(int(n), 1);
+    std::vector<int> out(n);
+    volatile size_t sink = 0;
+    std::cout << "algorithms over a deque<int> of " << n << " elements x" << rounds << " (ms)" << std::endl;
+    std::cout << std::setw(22) << "" << std::setw(12) << "element" << std::setw(12) << "segmented" << std::endl;
+    segment_row("fill", rounds,
+        [&] { STL::__fill(d.begin(), d.end(), 2, std::false_type()); },
+        [&] { STL::fill(d.begin(), d.end(), 2); });
+    segment_row("fill_n", rounds,
+        [&] { STL::__fill_n(d.begin(), n, 3, std::false_type()); },
+        [&] { STL::fill_n(d.begin(), n, 3); });
+    segment_row("copy to int*", rounds,
+        [&] { STL::__copy_elements(d.begin(), d.end(), out.data()); },
+        [&] { STL::copy(d.begin(), d.end(), out.data()); });
+    segment_row("copy from int*", rounds,
+        [&] { STL::__copy_elements(out.data(), out.data() + n, d.begin()); },
+        [&] { STL::copy(out.data(), out.data() + n, d.begin()); });
+    segment_row("find (absent)", rounds,
+        [&] { sink += STL::__find(d.begin(), d.end(), -1, std::false_type()) - d.begin(); },
+        [&] { sink += STL::find(d.begin(), d.end(), -1) - d.begin(); });
+    segment_row("count", rounds,
+        [&] { sink += STL::__count(d.begin(), d.end(), 3, std::false_type()); },
+        [&] { sink += STL::count(d.begin(), d.end(), 3); });
+    long long sum = 0;
+    segment_row("for_each (sum)", rounds,
+        [&] { STL::__for_each(d.begin(), d.end(), [&sum](int x) { sum += x; }, std::false_type()); },
+        [&] { STL::for_each(d.begin(), d.end(), [&sum](int x) { sum += x; }); });
+    sink += size_t(sum);
+}
+
+/*
+ * 固定大小的滑动窗口：每来一个元素就放入队尾，超过window个时丢掉最旧的
+ * queue<deque>要自己判断大小再pop，deque每走完一个缓存区还要换缓存区、挪map；
+ * queue<circular_buffer>用overwrite策略，push一次就完成；批量一行每次push_n/pop_n一块，按两段memmove
+ */
+void ringWindowBench() {
+    typedef STL::circular_buffer<int> ring;
+    const size_t n = size_t(1) << 26, window = 4096, chunk = 1024;
+    std::vector<int> input(chunk), output(chunk);
+    for (size_t i = 0; i < chunk; ++ i) input[i] = int(i);
+    long long deque_sum = 0, ring_sum = 0, bulk_sum = 0;
+    double deque_ms = time_ms([&] {
+        STL::queue<int, STL::deque<int> > q;
+        for (size_t i = 0; i < n; ++ i) {
+            q.push(int(i));
+            if (q.size() > window) q.pop();
+            deque_sum += q.front();
+        }
+    });
+    double ring_ms = time_ms([&] {
+        STL::queue<int, ring> q(ring(window, ring::overwrite));
+        for (size_t i = 0; i < n; ++ i) {
+            q.push(int(i));
+            ring_sum += q.front();
+        }
+    });
+    double bulk_ms = time_ms([&] {
+        ring r(window * 2, ring::reject);
+        for (size_t i = 0; i < n; i += chunk) {
+            r.push_n(input.data(), chunk);
+            if (r.size() > window) bulk_sum += r.pop_n(output.data(), chunk) + output[chunk - 1];
+        }
+    });
+    std::cout << "sliding window of " << window << " ints over " << n << " pushes (ns per element)" << std::endl;
+    std::cout << std::setw(22) << "queue<deque>" << std::setw(12) << deque_ms * 1e6 / n << std::endl;
+    std::cout << std::setw(22) << "queue<circular_buffer>" << std::setw(12) << ring_ms * 1e6 / n
+              << (deque_sum == ring_sum ? "" : "  (mismatch)") << std::endl;
+    std::cout << std::setw(22) << ("push_n/pop_n x" + std::to_string(chunk)) << std::setw(12) << bulk_ms * 1e6 / n
+              << (bulk_sum != 0 ? "" : "  (sink)") << std::endl;
+}
+
+/*
+ * 有界队列吞吐量：P个生产者共放入n个int，C个消费者取走，每次try失败就让出CPU
+ * 加锁的STL::queue每个元素都要拿锁，底层list每次push还要申请一个节点；批量一行一次放/取一块
+ * spsc_queue的两端各自只写自己的下标，mpmc_queue每个槽一个序号，一次CAS认领一段
+ * 往返延迟：两个线程用两个队列来回传一个数，测的是一次交接的代价
+ */
+struct locked_queue {
+    STL::queue<int> q;
+    std::mutex m;
+    size_t count, limit; //list的size()要遍历，自己计数
+
+    explicit locked_queue(size_t capacity) : count(0), limit(capacity) {}
+    bool try_push(int val) {
+        std::lock_guard<std::mutex> lock(m);
+        if (count == limit) return false;
+        q.push(val);
+        ++ count;
+        return true;
+    }
+    bool try_pop(int& out) {
+        std::lock_guard<std::mutex> lock(m);
+        if (count == 0) return false;
+        out = q.front();
+        q.pop();
+        -- count;
+        return true;
+    }
+    size_t try_push_n(const int* first, size_t n) {
+        std::lock_guard<std::mutex> lock(m);
+        size_t k = 0;
+        for (; k < n && count < limit; ++ k, ++ count) q.push(first[k]);
+        return k;
+    }
+    size_t try_pop_n(int* out, size_t n) {
+        std::lock_guard<std::mutex> lock(m);
+        size_t k = 0;
+        for (; k < n && count > 0; ++ k, -- count) {
+            out[k] = q.front();
+            q.pop();
+        }
+        return k;
+    }
+};
+
+template <class Queue>
+void queue_throughput_row(const char* name, unsigned producers, unsigned consumers, size_t n, size_t batch) {
+    const size_t capacity = 1024;
+    Queue q(capacity);
+    std::atomic<long long> sum(0);
+    std::atomic<size_t> remaining(n);
+    double ms = time_ms([&] {
+        std::vector<std::thread> workers;
+        for (unsigned p = 0; p < producers; ++ p) {
+            workers.emplace_back([&, p] {
+                std::vector<int> buf(batch);
+                size_t begin = n * p / producers, end = n * (p + 1) / producers;
+                for (size_t i = begin; i < end; ) {
+                    size_t k;
+                    if (batch == 1) k = q.try_push(int(i));
+                    else {
+                        size_t len = std::min(batch, end - i);
+                        for (size_t j = 0; j < len; ++ j) buf[j] = int(i + j);
+                        k = q.try_push_n(buf.data(), len);
+                    }
+                    if (k == 0) std::this_thread::yield();
+                    i += k;
+                }
+            });
+        }
+        for (unsigned c = 0; c < consumers; ++ c) {
+            workers.emplace_back([&] {
+                std::vector<int> buf(batch);
+                long long local = 0;
+                while (remaining.load(std::memory_order_relaxed) > 0) {
+                    size_t k = batch == 1 ? size_t(q.try_pop(buf[0])) : q.try_pop_n(buf.data(), batch);
+                    if (k == 0) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    for (size_t j = 0; j < k; ++ j) local += buf[j];
+                    remaining.fetch_sub(k, std::memory_order_relaxed);
+                }
+                sum += local;
+            });
+        }
+        for (auto &w : workers) w.join();
+    });
+    long long expect = (long long)n * (long long)(n - 1) / 2;
+    std::cout << std::setw(22) << name << std::setw(12) << producers << "P/" << consumers << "C"
+              << std::setw(12) << (batch == 1 ? std::string("1") : "x" + std::to_string(batch))
+              << std::setw(12) << ms * 1e6 / n << (sum.load() == expect ? "" : "  (mismatch)") << std::endl;
+}
+
+template <class Queue>
+void queue_latency_row(const char* name, size_t rounds) {
+    Queue ping(64), pong(64);
+    double ms = time_ms([&] {
+        std::thread echo([&] {
+            int x;
+            for (size_t i = 0; i < rounds; ++ i) {
+                while (!ping.try_pop(x)) std::this_thread::yield();
+                while (!pong.try_push(x + 1)) std::this_thread::yield();
+            }
+        });
+        int x = 0;
+        for (size_t i = 0; i < rounds; ++ i) {
+            while (!ping.try_push(x)) std::this_thread::yield();
+            while (!pong.try_pop(x)) std::this_thread::yield();
+        }
+        echo.join();
+    });
+    std::cout << std::setw(22) << name << std::setw(12) << ms * 1e6 / rounds << std::endl;
+}
+
+void concurrentQueueBench() {
+    const size_t n = size_t(1) << 22, rounds = size_t(1) << 16;
+    std::cout << "bounded queue throughput, " << n << " ints, capacity 1024 (threads, batch, ns per item)" << std::endl;
+    queue_throughput_row<locked_queue>("mutex + STL::queue", 1, 1, n, 1);
+    queue_throughput_row<STL::spsc_queue<int>>("spsc_queue", 1, 1, n, 1);
+    queue_throughput_row<STL::mpmc_queue<int>>("mpmc_queue", 1, 1, n, 1);
+    queue_throughput_row<locked_queue>("mutex + STL::queue", 1, 1, n, 64);
+    queue_throughput_row<STL::spsc_queue<int>>("spsc_queue", 1, 1, n, 64);
+    queue_throughput_row<STL::mpmc_queue<int>>("mpmc_queue", 1, 1, n, 64);
+    queue_throughput_row<locked_queue>("mutex + STL::queue", 2, 2, n, 1);
+    queue_throughput_row<STL::mpmc_queue<int>>("mpmc_queue", 2, 2, n, 1);
+    queue_throughput_row<locked_queue>("mutex + STL::queue", 2, 2, n, 64);
+    queue_throughput_row<STL::mpmc_queue<int>>("mpmc_queue", 2, 2, n, 64);
+    std::cout << "ping-pong round trip, " << rounds << " rounds (ns per round trip)" << std::endl;
+    queue_latency_row<locked_queue>("mutex + STL::queue", rounds);
+    queue_latency_row<STL::spsc_queue<int>>("spsc_queue", rounds);
+    queue_latency_row<STL::mpmc_queue<int>>("mpmc_queue", rounds);
+}
+
+int main() {
+    allocThreadBench();
+    mapChurnBench();
+    arenaBench();
+    hugePageBench();
+    vectorRelocateBench();
+    vectorPresizeBench();
+    smallVectorBench();
+    vectorGrowthBench();
+    vectorRangeBench();
+    soaScanBench();
+    mmapLoadBench();
+    dynamicBitsetBench();
+    workStealingBench();
+    dequeFifoBench();
+    dequeSegmentBench();
+    ringWindowBench();
+    concurrentQueueBench();
+    return 0;
+}
@@ -2,6 +2,13 @@
 #include "allocator.h"
 #include <vector>
 #include "vector.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "mmap_vector.h"
+#include "dynamic_bitset.h"
+#include "work_stealing_deque.h"
+#include "circular_buffer.h"
+#include "concurrent_queue.h"
 #include "list.h"
 #include "deque.h"
 #include "stack.h"
@@ -12,6 +19,9 @@
 #include "unordered_set.h"
 #include "unordered_map.h"
 #include "algorithm.h"
+#include "arena.h"
+#include <thread>
+#include <string>
 
 void allocatorTest() { //测试自己写的allocator与std::vector的交互
     std::vector<int, STL::allocator<int> > v1;
@@ -26,6 +36,204 @@ void allocatorTest() { //测试自己写的allocator与std::vector的交互
     std::cout << std::endl;
 }
 
+void allocThreadTest() { //多个线程同时使用alloc，各自构建容器
+    std::vector<std::thread> workers;
+    long long sum[4] = {0, 0, 0, 0};
+    for (int t = 0; t < 4; ++ t) {
+        workers.emplace_back([t, &sum] {
+            for (int round = 0; round < 100; ++ round) {
+                STL::list<int> l;
+                for (int i = 0; i < 1000; ++ i) l.push_back(i);
+                for (auto i : l) sum[t] += i;
+            }
+        });
+    }
+    for (auto &w : workers) w.join();
+    std::cout << "thread sums: ";
+    for (int t = 0; t < 4; ++ t) std::cout << sum[t] << " ";
+    std::cout << std::endl;
+}
+
+void allocTrimTest() { //释放大量节点后，trim应把完全空闲的chunk还给系统
+    size_t before = STL::alloc::pool_size();
+    {
+        STL::list<int> l;
+        for (int i = 0; i < 100000; ++ i) l.push_back(i);
+    }
+    size_t peak = STL::alloc::pool_size();
+    size_t reclaimed = STL::alloc::trim();
+    std::cout << "pool grew: " << (peak > before) << " trim reclaimed: " << (reclaimed > 0)
+              << " pool shrank: " << (STL::alloc::pool_size() < peak) << std::endl;
+}
+
+void allocStatsTest() { //打印分配统计，编译时定义MY_TINY_STL_ALLOC_STATS可看到每级区块的计数
+    STL::vector<int> v(10, 1);
+    STL::list<int> l(10, 1);
+    STL::alloc::print_stats(std::cout);
+    STL::alloc::print_stats_json(std::cout);
+}
+
+void allocReallocateTest() { //reallocate需保留原有内容
+    char* p = static_cast<char*>(STL::alloc::allocate(16));
+    for (int i = 0; i < 16; ++ i) p[i] = char('a' + i);
+    p = static_cast<char*>(STL::alloc::reallocate(p, 16, 100));
+    p = static_cast<char*>(STL::alloc::reallocate(p, 100, 1000));
+    p = static_cast<char*>(STL::alloc::reallocate(p, 1000, 10000));
+    p = static_cast<char*>(STL::alloc::reallocate(p, 10000, 16));
+    std::cout << "reallocate keeps data: " << std::string(p, 16) << std::endl;
+    STL::alloc::deallocate(p, 16);
+}
+
+void allocHugePageTest() { //开启大页后新chunk按2MB取整，系统不支持时退回普通页，结果相同
+    STL::alloc::set_huge_pages(true);
+    size_t before = STL::alloc::pool_size();
+    {
+        STL::list<int> l;
+        for (int i = 0; i < 100000; ++ i) l.push_back(i);
+        size_t grown = STL::alloc::pool_size() - before;
+        std::cout << "huge pages: " << STL::alloc::huge_pages() << " " << (grown > 0 && grown % (2 << 20) == 0)
+                  << " " << l.back() << std::endl;
+    }
+    STL::alloc::flush_thread_cache();
+    STL::alloc::trim();
+    STL::alloc::set_huge_pages(false);
+}
+
+void allocDebugTest() { //编译时定义MY_TINY_STL_ALLOC_DEBUG才会登记区块，未释放的一块应被报告
+    void* a = STL::alloc::allocate(24);
+    void* b = STL::alloc::allocate(5000);
+    void* c = STL::alloc::allocate(100, 64);
+    STL::alloc::deallocate(a, 24);
+    STL::alloc::deallocate(c, 100, 64);
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+    size_t expected = 1;
+#else
+    size_t expected = 0;
+#endif
+    std::cout << "leak report: " << (STL::alloc::report_leaks(std::cout) == expected) << std::endl;
+    STL::alloc::deallocate(b, 5000);
+}
+
+struct alignas(32) simd_lane { //过对齐类型，vector/list的元素与节点都应32字节对齐
+    float x[8];
+};
+
+struct alignas(128) padded_counter {
+    long value;
+};
+
+void allocAlignTest() { //每个地址都满足要求的对齐时输出1
+    bool ok = true;
+    STL::vector<simd_lane> v;
+    for (int i = 0; i < 100; ++ i) {
+        v.push_back(simd_lane());
+        ok = ok && reinterpret_cast<size_t>(&v[0]) % 32 == 0;
+    }
+    STL::list<simd_lane> l(10, simd_lane());
+    for (auto& i : l) ok = ok && reinterpret_cast<size_t>(&i) % 32 == 0;
+    STL::vector<float, STL::aligned_allocator<float, 64> > buf(1000, 1.0f);
+    ok = ok && reinterpret_cast<size_t>(&buf[0]) % 64 == 0;
+    STL::vector<padded_counter> slots(8, padded_counter());
+    ok = ok && reinterpret_cast<size_t>(&slots[0]) % 128 == 0;
+    for (size_t bytes = 1; bytes <= 8192; bytes = bytes * 3 / 2 + 1) {
+        for (size_t align = 8; align <= 256; align *= 2) {
+            void* p = STL::alloc::allocate(bytes, align);
+            ok = ok && reinterpret_cast<size_t>(p) % align == 0;
+            STL::alloc::deallocate(p, bytes, align);
+        }
+    }
+    std::cout << "aligned: " << ok << std::endl;
+}
+
+void arenaTest() { //各容器以arena_allocator为Alloc，节点都来自arena，离开作用域后整体释放
+    STL::monotonic_arena arena;
+    {
+        STL::arena_scope scope(arena);
+        STL::vector<int, STL::arena_allocator<int> > v;
+        STL::list<int, STL::arena_allocator<int> > l;
+        STL::deque<int, STL::arena_allocator<int> > d;
+        STL::multiset<int, STL::less<int>, STL::arena_allocator<int> > s;
+        STL::map<int, int, STL::less<int>, STL::arena_allocator<std::pair<const int, int> > > mp;
+        STL::unordered_map<int, int, STL::hash<int>, STL::equal_to<int>,
+                STL::arena_allocator<std::pair<const int, int> > > ump;
+        for (int i = 0; i < 1000; ++ i) {
+            v.push_back(i);
+            l.push_back(i);
+            d.push_back(i);
+            s.insert(i % 10);
+            mp[i] = i * 2;
+            ump[i] = i * 3;
+        }
+        int sum = 0;
+        for (auto i : l) sum += i;
+        std::cout << "arena: " << v[999] << " " << sum << " " << d[500] << " " << s.count(7)
+                  << " " << mp[10] << " " << ump[10] << std::endl;
+        std::cout << "arena used > 0: " << (arena.used() > 0) << std::endl;
+        //元素可平凡析构，clear不遍历节点，直接置空后仍可继续使用
+        l.clear();
+        d.clear();
+        s.clear();
+        mp.clear();
+        ump.clear();
+        l.push_back(1);
+        d.push_back(2);
+        s.insert(3);
+        mp[4] = 4;
+        ump[5] = 5;
+        std::cout << "arena clear: " << l.size() << d.size() << s.size() << mp.size() << ump.size()
+                  << " " << l.front() << d.front() << *s.begin() << mp[4] << ump[5] << std::endl;
+    }
+    arena.release();
+    std::cout << "arena after release: " << arena.used() << " " << arena.capacity() << std::endl;
+}
+
+void statefulAllocatorTest() { //每个容器持有自己的配置器实例，两个arena互不干扰
+    typedef STL::arena_allocator<int> int_alloc;
+    typedef STL::arena_allocator<std::pair<const int, int> > pair_alloc;
+    STL::monotonic_arena hot, cold;
+    {
+        STL::vector<int, int_alloc> v((int_alloc(hot)));
+        STL::list<int, int_alloc> l((int_alloc(cold)));
+        STL::deque<int, int_alloc> d((int_alloc(hot)));
+        STL::map<int, int, STL::less<int>, pair_alloc> mp((pair_alloc(hot)));
+        STL::unordered_map<int, int, STL::hash<int>, STL::equal_to<int>, pair_alloc> ump((pair_alloc(cold)));
+        for (int i = 0; i < 100; ++ i) {
+            v.push_back(i);
+            l.push_back(i);
+            d.push_back(i);
+            mp[i] = i;
+            ump[i] = i;
+        }
+        size_t hot_used = hot.used(), cold_used = cold.used();
+        std::cout << "stateful: " << (v.get_allocator().resource() == &hot)
+                  << (l.get_allocator().resource() == &cold) << (d.get_allocator().resource() == &hot)
+                  << (mp.get_allocator().resource() == &hot) << (ump.get_allocator().resource() == &cold) << std::endl;
+
+        STL::vector<int, int_alloc> copy(v); //复制构造沿用原来的arena
+        STL::vector<int, int_alloc> other((int_alloc(cold)));
+        other = v; //复制赋值保留自己的arena
+        std::cout << "copy: " << (copy.get_allocator().resource() == &hot) << (other.get_allocator().resource() == &cold)
+                  << " " << other[99] << std::endl;
+        other.swap(copy); //交换时arena随内容一起交换
+        std::cout << "swap: " << (other.get_allocator().resource() == &hot) << (copy.get_allocator().resource() == &cold)
+                  << " " << (hot.used() > hot_used) << (cold.used() > cold_used) << std::endl;
+
+        STL::map<int, int, STL::less<int>, pair_alloc> mp2((pair_alloc(cold)));
+        mp2 = mp;
+        STL::list<int, int_alloc> l2(l);
+        size_t before_sort = cold.used();
+        l2.sort(); //排序用的临时list也从l2的arena分配哨兵节点
+        bool sorted_on_cold = cold.used() > before_sort;
+        copy.assign(1000, 7); //扩容重建时仍用自己的arena
+        std::cout << "copied: " << mp2.size() << " " << (mp2.get_allocator().resource() == &cold)
+                  << (copy.get_allocator().resource() == &cold)
+                  << " " << l2.back() << " " << (l2.get_allocator().resource() == &cold)
+                  << sorted_on_cold << std::endl;
+    }
+    hot.release();
+    cold.release();
+}
+
 template<class T>
 void print(T &v) {
     std::cout << "size: " << v.size() << std::endl;
@@ -206,6 +414,54 @@ void stackTest() {
     }
 }
 
+void dequeBlockTest() { //按字节指定缓存区大小、大元素的最少扇出；先进先出的稳定状态下不再向配置器申请
+    struct big { char bytes[600]; };
+    std::cout << "deque block: " << STL::deque<int, STL::allocator<int>, STL::deque_block_size(4096, sizeof(int))>::iterator::buf_size()
+              << " " << STL::deque<big>::iterator::buf_size() << " " << STL::deque<int>::iterator::buf_size();
+    typedef STL::arena_allocator<int> int_alloc;
+    STL::monotonic_arena arena;
+    {
+        STL::deque<int, int_alloc> d((int_alloc(arena)));
+        for (int i = 0; i < 1000; ++ i) d.push_back(i);
+        for (int i = 0; i < 1000; ++ i) d.push_back(i), d.pop_front();
+        size_t used = arena.used();
+        long long sum = 0;
+        for (int i = 0; i < 100000; ++ i) {
+            sum += d.front();
+            d.pop_front();
+            d.push_back(i);
+        }
+        d.shrink_to_fit();
+        d.erase(d.begin() + 10, d.end() - 10);
+        d.push_front(-1);
+        std::cout << " " << (arena.used() == used) << " " << sum << " " << d.size() << " " << d.front() << d[1] << " " << d.back() << std::endl;
+    }
+}
+
+void dequeSegmentTest() { //分段算法跨越多个缓存区，区间端点落在缓存区边界上也要正确
+    typedef STL::deque<int, STL::allocator<int>, 8> deque8; //每个缓存区8个元素，便于构造跨段区间
+    deque8 d(50, 0);
+    for (int i = 0; i < 50; ++ i) d[i] = i;
+    STL::fill(d.begin() + 3, d.begin() + 29, 7);
+    deque8::iterator e = STL::fill_n(d.begin() + 2, 14, 9); //正好停在第三段开头
+    int buf[50];
+    int* p = STL::copy(d.begin(), d.end(), buf);
+    deque8 d2(50, -1);
+    STL::copy(buf + 1, buf + 41, d2.begin() + 5);
+    deque8::iterator c = STL::copy(d.begin() + 30, d.begin() + 45, d2.begin() + 30);
+    int sum = 0;
+    STL::for_each(d2.begin(), d2.end(), [&sum](int x) { sum += x; });
+    std::cout << "deque segments: " << (e - d.begin()) << *e << " " << (p - buf) << buf[15] << buf[29] << " "
+              << (c - d2.begin()) << " " << sum << " " << (STL::find(d.begin(), d.end(), 29) - d.begin())
+              << " " << (STL::find(d.begin() + 30, d.begin() + 40, 29) - d.begin())
+              << " " << (STL::find(d.begin() + 5, d.begin() + 6, 9) - d.begin())
+              << " " << STL::count(d.begin() + 1, d.end() - 1, 7) << STL::count(d.begin(), d.begin(), 7);
+    std::string raw[20];
+    STL::deque<std::string> ds(20, "s");
+    STL::copy(ds.begin(), ds.end(), raw);
+    std::cout << " " << raw[19] << std::endl;
+}
+
 void queueTest() {
     STL::queue<int> q;
     q.push(1);
@@ -307,16 +563,481 @@ void algorithmTest() {
     std::cout << *STL::lower_bound(v.begin(), v.end(), -3) << std::endl;
 }
 
+struct tracked { //统计复制和移动的次数
+    static int copies;
+    static int moves;
+    std::string s;
+    tracked(const char* str = "") : s(str) {}
+    tracked(const tracked& rhs) : s(rhs.s) { ++ copies; }
+    tracked(tracked&& rhs) noexcept : s(std::move(rhs.s)) { ++ moves; }
+    tracked& operator=(const tracked& rhs) { s = rhs.s; ++ copies; return *this; }
+    tracked& operator=(tracked&& rhs) noexcept { s = std::move(rhs.s); ++ moves; return *this; }
+};
+int tracked::copies = 0;
+int tracked::moves = 0;
+
+void moveTest() { //右值插入、emplace、扩容和容器移动都不应复制元素
+    tracked::copies = 0;
+    STL::vector<tracked> v;
+    for (int i = 0; i < 100; ++ i) v.push_back(tracked("v"));
+    v.emplace_back("e");
+    v.emplace(v.begin() + 1, "m");
+    v.insert(v.begin(), tracked("i"));
+    STL::list<tracked> l;
+    l.push_back(tracked("b"));
+    l.emplace_front("f");
+    l.emplace(++ l.begin(), "m");
+    STL::deque<tracked> d;
+    for (int i = 0; i < 100; ++ i) d.emplace_back("d");
+    d.emplace_front("f");
+    d.push_front(tracked("p"));
+    d.emplace(d.begin() + 3, "x");
+    d.emplace(d.end() - 3, "y");
+    std::cout << "copies: " << tracked::copies << " " << v[0].s << v[1].s << v[2].s << v.back().s
+              << " " << l.front().s << (++ l.begin())->s << l.back().s
+              << " " << d[0].s << d[1].s << d[3].s << d[d.size() - 4].s << std::endl;
+
+    tracked* data = v.data();
+    STL::vector<tracked> v2(std::move(v));
+    STL::vector<tracked> v3;
+    v3 = std::move(v2);
+    STL::list<tracked> l2(std::move(l));
+    STL::deque<tracked> d2;
+    d2 = std::move(d);
+    d.push_back(tracked("again")); //移动后的容器仍然可用
+    STL::map<int, int> m;
+    m[1] = 2;
+    STL::map<int, int> m2(std::move(m));
+    m.insert({2, 3}); //移动后的map也仍然可用
+    m[4] = 5;
+    STL::unordered_map<int, int> um;
+    um[1] = 2;
+    STL::unordered_map<int, int> um2;
+    um2 = std::move(um);
+    um[3] = 4;
+    std::cout << "moved: " << tracked::copies << " " << (v3.data() == data) << " " << v.empty() << v2.empty()
+              << " " << l2.size() << l.size() << " " << d2.size() << d.size() << " " << m2[1]
+              << m.size() << m.begin()->second << " " << um2[1] << um.size() << std::endl;
+}
+
+struct handle { //独占一个int的句柄，不可平凡复制，但可以按字节搬移
+    int* p;
+    explicit handle(int v = 0) : p(new int(v)) {}
+    handle(handle&& rhs) noexcept : p(rhs.p) { rhs.p = nullptr; }
+    handle& operator=(handle&& rhs) noexcept { std::swap(p, rhs.p); return *this; }
+    ~handle() { delete p; }
+};
+namespace STL {
+    template<> struct is_trivially_relocatable<handle> : std::true_type {};
+}
+
+void relocateTest() { //按字节搬移的扩容、插入、删除后内容不变且不泄漏
+    STL::vector<handle> v;
+    for (int i = 0; i < 1000; ++ i) v.emplace_back(i);
+    v.emplace(v.begin() + 10, -1);
+    v.erase(v.begin());
+    v.erase(v.begin() + 100, v.begin() + 200);
+    v.shrink_yo_fit();
+    long long sum = 0;
+    for (auto& h : v) sum += *h.p;
+    std::cout << "relocate: " << v.size() << " " << sum << " " << std::is_same<STL::__type_traits<double*>::is_POD_type, STL::__true_type>::value << std::endl;
+}
+
+void uninitializedTest() { //未初始化区间上的移动、默认初始化、值初始化
+    tracked::copies = tracked::moves = 0;
+    STL::allocator<tracked> a;
+    tracked src[3] = {"a", "b", "c"};
+    tracked* dst = a.allocate(3);
+    tracked* end = STL::uninitialized_move(src, src + 2, dst);
+    auto r = STL::uninitialized_move_n(src + 2, 1, end);
+    std::cout << "uninitialized: " << tracked::copies << tracked::moves << " " << dst[0].s << dst[1].s << dst[2].s
+              << (r.first == src + 3) << (r.second == dst + 3);
+    STL::destroy(dst, dst + 3);
+    a.deallocate(dst, 3);
+
+    int raw[4] = {7, 7, 7, 7};
+    STL::uninitialized_value_construct(raw, raw + 2);
+    STL::uninitialized_default_construct_n(raw + 2, 2); //可平凡默认构造的元素不被改写
+    std::cout << " " << raw[0] << raw[1] << raw[2] << raw[3];
+
+    STL::vector<int> v(3);
+    v[0] = 5;
+    v.resize_default_init(1000);
+    v.resize_default_init(2);
+    STL::vector<std::string> vs;
+    vs.resize_default_init(3);
+    STL::vector<handle> vh(4); //不可复制的元素也能按个数构造
+    struct fixed { const int x; }; //可平凡复制但不能赋值，只能原地构造
+    fixed f = {9};
+    STL::vector<fixed> vf(3, f);
+    STL::list<fixed> lf;
+    lf.push_back(f);
+    STL::vector<fixed> vl(lf.begin(), lf.end());
+    std::cout << " " << v.size() << v[0] << v[1] << " " << vs.size() << vs[2].empty() << " " << vh.size() << *vh[3].p
+              << " " << vf[2].x << vl.size() << std::endl;
+}
+
+void smallVectorTest() { //不超过N个元素时不离开内联缓冲区，超过后搬到堆上，移动、交换、收缩后内容不变
+    STL::small_vector<int, 4> v;
+    for (int i = 0; i < 4; ++ i) v.push_back(i);
+    bool inline4 = v.is_inline();
+    v.insert(v.begin() + 1, 2, 9);
+    v.erase(v.begin());
+    std::cout << "small_vector: " << inline4 << v.is_inline() << " ";
+    print(v);
+    v.erase(v.begin() + 1, v.end() - 1);
+    v.shrink_yo_fit();
+    STL::small_vector<int, 4> w(3, 7);
+    w.swap(v);
+    std::cout << v.is_inline() << w.is_inline() << " " << v.size() << w.size() << w[0] << w[1] << (v == w) << std::endl;
+
+    tracked::copies = 0;
+    STL::small_vector<tracked, 2> t;
+    t.emplace_back("a");
+    t.emplace(t.begin(), "b");
+    t.push_back(tracked("c"));
+    STL::small_vector<tracked, 2> t2(std::move(t));
+    STL::small_vector<tracked, 2> t3;
+    t3.emplace_back("x");
+    t3 = std::move(t2);
+    STL::small_vector<handle, 8> h;
+    for (int i = 0; i < 20; ++ i) h.emplace_back(i);
+    h.erase(h.begin() + 3, h.end());
+    h.shrink_yo_fit();
+    STL::small_vector<handle, 8> h2(std::move(h));
+    std::cout << "small_vector moved: " << tracked::copies << " " << t3[0].s << t3[1].s << t3[2].s << t.empty() << t2.empty()
+              << " " << h2.is_inline() << *h2[2].p << h.size() << std::endl;
+
+    typedef STL::arena_allocator<int> int_alloc;
+    STL::monotonic_arena hot, cold;
+    {
+        STL::small_vector<int, 4, int_alloc> from((int_alloc(hot))), to((int_alloc(cold)));
+        from.push_back(1);
+        for (int i = 0; i < 10; ++ i) to.push_back(i);
+        to = std::move(from); //arena随内容一起移动，即使内容在内联缓冲区中
+        std::cout << "small_vector arena: " << (to.get_allocator().resource() == &hot) << to.is_inline() << to[0] << std::endl;
+    }
+    hot.release();
+    cold.release();
+}
+
+void vectorGrowthTest() { //各扩容策略下的容量序列，按区块大小上调时reserve得到的容量不小于请求
+    STL::vector<int> v;
+    v.reserve(5);
+    STL::vector<int, STL::allocator<int>, STL::vector_growth_double> d;
+    d.reserve(5);
+    std::cout << "growth: " << STL::alloc::usable_size(100) << " " << v.capacity() << " " << d.capacity() << " |";
+    STL::vector<int, STL::allocator<int>, STL::vector_growth_golden> g;
+    size_t last = 0;
+    for (int i = 0; i < 100; ++ i) {
+        g.push_back(i);
+        if (g.capacity() != last) std::cout << " " << (last = g.capacity());
+    }
+    std::cout << " | " << g[99] << std::endl;
+}
+
+void vectorRangeTest() { //区间构造、插入、赋值，来源可以是数组、list、deque、hashtable
+    int a[] = {1, 2, 3, 4, 5};
+    STL::list<int> l;
+    for (int i = 10; i < 13; ++ i) l.push_back(i);
+    STL::deque<int> d;
+    d.push_back(20);
+    d.push_front(19);
+    STL::unordered_set<int> us;
+    us.insert(30);
+    STL::vector<int> v(a, a + 5);
+    v.insert(v.begin() + 1, l.begin(), l.end()); //容量不足，重新分配
+    v.reserve(64);
+    v.insert(v.begin() + 2, d.begin(), d.end()); //备用空间足够
+    v.append_range(us);
+    v.insert(v.begin(), 3, 0);
+    v.insert(v.begin() + 1, 100, 7); //重新分配后内容应完整
+    std::cout << "vector range: " << v.size() << " " << v[0] << v[1] << v[100] << v[101] << " " << v[103] << v[104]
+              << v[105] << v[106] << v[107] << " " << v.back() << std::endl;
+
+    STL::vector<std::string> s(3, "x");
+    std::string words[] = {"a", "b", "c", "d"};
+    s.reserve(16);
+    s.insert(s.begin() + 1, words, words + 1); //插入点之后的元素多于插入的个数
+    s.insert(s.begin() + 3, words + 1, words + 4); //插入点之后的元素少于插入的个数
+    std::string joined;
+    for (auto& w : s) joined += w;
+    STL::vector<std::string> t(l.size(), "y");
+    t.assign(words, words + 4);
+    std::string assigned;
+    for (auto& w : t) assigned += w;
+    t.assign(words + 2, words + 3);
+    STL::vector<int> from_list(l.begin(), l.end());
+    std::cout << "vector range: " << joined << " " << assigned << " " << t.size() << t[0]
+              << " " << from_list.size() << from_list[2] << std::endl;
+}
+
+void soaVectorTest() { //按列存储：行代理读写、列视图、删除、扩容时追加本容器中的行
+    STL::soa_vector<int, double, std::string> v;
+    for (int i = 0; i < 8; ++ i) v.push_back(i, i * 0.5, std::to_string(i));
+    v.push_back(v[0]); //8行时容量已满，追加自身的一行
+    std::get<2>(v[0]) = "zero";
+    v.erase(v.begin() + 1, v.begin() + 3);
+    v.erase(v.begin() + 2);
+    v.emplace_back(100, 1.5, "x");
+    double sum = 0;
+    for (double d : v.column<1>()) sum += d;
+    STL::soa_vector<int, double, std::string> w(v);
+    v.resize(20);
+    v.pop_back();
+    std::cout << "soa_vector: " << v.size() << " " << sum << " " << std::get<2>(w[0]) << std::get<2>(w[w.size() - 2])
+              << " " << std::get<2>(v[18]).empty() << (reinterpret_cast<size_t>(v.data<0>()) % 64) << " |";
+    for (auto r : w) std::cout << " " << std::get<0>(r);
+    std::cout << std::endl;
+}
+
+void mmapVectorTest() { //写入文件后重新打开，元素个数由文件大小得出；只读模式下修改会抛出异常
+    const char* path = "mmap_vector_test.bin";
+    std::remove(path);
+    {
+        STL::mmap_vector<int> v(path);
+        for (int i = 0; i < 5000; ++ i) v.push_back(5000 - i);
+        STL::sort(v.begin(), v.end());
+        v.erase(v.begin(), v.begin() + 1000);
+        v.flush();
+    }
+    long long sum = 0;
+    bool sorted = true;
+    bool threw = false;
+    size_t reopened = 0;
+    {
+        STL::mmap_vector<int> v(path, STL::mmap_vector<int>::read_only);
+        reopened = v.size();
+        for (size_t i = 0; i < v.size(); ++ i) {
+            sum += v[i];
+            if (i > 0 && v[i - 1] > v[i]) sorted = false;
+        }
+        try { v.push_back(1); } catch (const std::system_error&) { threw = true; }
+    }
+    STL::mmap_vector<int> v(path);
+    v.resize(4002);
+    std::cout << "mmap_vector: " << reopened << " " << sum << " " << sorted << threw << " " << v[0] << " " << v[4001] << std::endl;
+    v.close();
+    std::remove(path);
+}
+
+void dynamicBitsetTest() { //区间置位跨字边界、逐字运算、按ctz查找、rank/select与逐位计算一致
+    STL::dynamic_bitset<> a(200), b(200, true);
+    a.set(3).set(64).set_range(130, 190);
+    b.reset_range(0, 128);
+    for (int i = 0; i < 70; ++ i) b.push_back(i % 7 == 0);
+    a.resize(270);
+    STL::dynamic_bitset<> c = a & b, d = a | b;
+    bool first = a.test_set(5), second = a.test_set(5);
+    std::cout << "dynamic_bitset: " << a.count() << " " << b.count() << " " << c.count() << " " << d.count()
+              << " " << (a ^ a).none() << (~STL::dynamic_bitset<>(70)).all() << " " << first << second << " |";
+    for (size_t i = a.find_first(); i < 135; i = a.find_next(i)) std::cout << " " << i;
+    std::cout << " | " << (d.find_next(269) == STL::dynamic_bitset<>::npos) << " ";
+    STL::bitset_rank_select<> rs(d);
+    bool ok = true;
+    size_t ones = 0;
+    for (size_t i = 0; i <= d.size(); ++ i) {
+        if (rs.rank(i) != ones) ok = false;
+        if (i < d.size() && d[i]) {
+            if (rs.select(ones) != i) ok = false;
+            ++ ones;
+        }
+    }
+    d -= a;
+    std::cout << ok << " " << rs.ones() << " " << (rs.select(ones) == STL::dynamic_bitset<>::npos) << " " << d.count() << std::endl;
+}
+
+void workStealingDequeTest() { //所有者LIFO、窃取FIFO、扩容；并发时每个元素恰好被取走一次
+    STL::work_stealing_deque<int> q(4);
+    for (int i = 0; i < 10; ++ i) q.push(i);
+    int x = -1, y = -1;
+    q.pop(x);
+    q.steal(y);
+    std::cout << "work_stealing_deque: " << q.capacity() << " " << x << y << " " << q.size();
+    while (q.pop(x)) {}
+    std::cout << " " << q.steal(y) << q.empty();
+
+    const int n = 200000, thieves = 3;
+    STL::work_stealing_deque<int> w;
+    std::vector<unsigned char> taken(n, 0);
+    std::atomic<int> done(0);
+    std::atomic<long long> count(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < thieves; ++ t) {
+        workers.emplace_back([&] {
+            int v;
+            long long c = 0;
+            while (done.load() == 0 || !w.empty()) {
+                if (w.steal(v)) ++ taken[v], ++ c;
+            }
+            count += c;
+        });
+    }
+    int v;
+    long long c = 0;
+    for (int i = 0; i < n; ++ i) {
+        w.push(i);
+        if (i % 3 == 0 && w.pop(v)) ++ taken[v], ++ c;
+    }
+    while (w.pop(v)) ++ taken[v], ++ c;
+    done = 1;
+    for (auto &t : workers) t.join();
+    count += c;
+    bool once = true;
+    for (int i = 0; i < n; ++ i) if (taken[i] != 1) once = false;
+    std::cout << " | " << count.load() << " " << once << std::endl;
+}
+
+void circularBufferTest() { //三种溢出策略、跨越回绕点的批量读写、作为queue/stack的底层容器
+    typedef STL::circular_buffer<int> ring;
+    ring g(4);
+    for (int i = 0; i < 10; ++ i) g.push_back(i);
+    g.push_front(-1);
+    ring w(4, ring::overwrite), r(3, ring::reject);
+    for (int i = 0; i < 10; ++ i) w.push_back(i);
+    w.push_front(100);
+    int accepted = 0;
+    for (int i = 0; i < 6; ++ i) accepted += r.push_back(i);
+    std::cout << "circular_buffer: " << g.capacity() << " " << g.size() << " " << g.front() << g.back() << " |";
+    for (auto x : w) std::cout << " " << x;
+    std::cout << " | " << r.capacity() << accepted << r.full();
+
+    STL::circular_buffer<char> bytes(8, STL::circular_buffer<char>::reject);
+    bytes.push_n("abcdef", 6);
+    STL::circular_buffer<char>::span_pair s = bytes.pop_n(4);
+    std::cout << " " << std::string(s.first, s.first_len) << " " << bytes.push_n("ghijklmn", 8);
+    s = bytes.peek_n(100);
+    std::cout << " " << std::string(s.first, s.first_len) << "+" << std::string(s.second, s.second_len);
+    char out[9] = {0};
+    bytes.pop_n(out, 3);
+    STL::circular_buffer<char>::span_pair ws = bytes.push_n(3);
+    for (size_t i = 0; i < ws.first_len; ++ i) ws.first[i] = 'X';
+    for (size_t i = 0; i < ws.second_len; ++ i) ws.second[i] = 'Y';
+    std::cout << " " << out << " ";
+    for (char c : bytes) std::cout << c;
+
+    STL::circular_buffer<std::string> strs(2);
+    strs.push_back("a");
+    strs.push_back("b");
+    strs.push_back(strs.front()); //扩容时参数引用本容器的元素
+    strs.set_policy(STL::circular_buffer<std::string>::overwrite);
+    strs.push_back("c");
+    strs.push_back(strs.front());
+    strs.push_front(strs.back());
+    std::cout << " | " << strs.capacity();
+    for (auto &x : strs) std::cout << " " << x;
+
+    STL::queue<int, ring> window(ring(4, ring::overwrite)); //最近4个
+    for (int i = 1; i <= 6; ++ i) window.push(i);
+    STL::stack<int, ring> st;
+    for (int i = 1; i <= 3; ++ i) st.push(i);
+    st.pop();
+    std::cout << " | " << window.size() << window.front() << window.back() << " " << st.size() << st.top() << std::endl;
+}
+
+void concurrentQueueTest() { //有界、批量；spsc保持顺序，mpmc每个元素恰好被取走一次
+    STL::spsc_queue<std::string> s(3);
+    int pushed = 0;
+    for (int i = 0; i < 6; ++ i) pushed += s.try_push(std::to_string(i));
+    std::string str;
+    s.try_pop(str);
+    std::cout << "concurrent queues: " << s.capacity() << pushed << " " << str << s.size();
+    STL::mpmc_queue<int> m(5);
+    int in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, out[10] = {0};
+    size_t first = m.try_push_n(in, 10), popped = m.try_pop_n(out, 3), second = m.try_push_n(in + 8, 2);
+    int x = -1;
+    bool last = m.try_push(42), full = !m.try_push(43);
+    std::cout << " | " << m.capacity() << first << popped << second << last << full << out[2] << " " << m.size();
+    while (m.try_pop(x)) {}
+    std::cout << x << m.empty();
+
+    const int n = 100000;
+    STL::spsc_queue<int> sq(64);
+    bool ordered = true;
+    std::thread consumer([&] {
+        int expect = 0, buf[16];
+        while (expect < n) {
+            size_t k = sq.try_pop_n(buf, 16);
+            if (k == 0) std::this_thread::yield();
+            for (size_t i = 0; i < k; ++ i) if (buf[i] != expect ++) ordered = false;
+        }
+    });
+    for (int i = 0; i < n; ) {
+        if (i % 3 == 0) {
+            int batch[5] = {i, i + 1, i + 2, i + 3, i + 4};
+            size_t k = sq.try_push_n(batch, std::min(5, n - i));
+            if (k == 0) std::this_thread::yield();
+            i += int(k);
+        }
+        else if (sq.try_push(i)) ++ i;
+        else std::this_thread::yield();
+    }
+    consumer.join();
+
+    STL::mpmc_queue<int> mq(128);
+    std::vector<unsigned char> seen(4 * n, 0);
+    std::atomic<int> remaining(4 * n);
+    std::vector<std::thread> workers;
+    for (int p = 0; p < 2; ++ p) {
+        workers.emplace_back([&, p] {
+            for (int i = 0; i < 2 * n; ) {
+                int batch[4] = {p * 2 * n + i, p * 2 * n + i + 1, p * 2 * n + i + 2, p * 2 * n + i + 3};
+                size_t k = i % 8 == 0 ? mq.try_push_n(batch, 4) : size_t(mq.try_push(batch[0]));
+                if (k == 0) std::this_thread::yield();
+                i += int(k);
+            }
+        });
+    }
+    for (int c = 0; c < 2; ++ c) {
+        workers.emplace_back([&] {
+            int buf[8];
+            while (remaining.load() > 0) {
+                size_t k = mq.try_pop_n(buf, 8);
+                if (k == 0) std::this_thread::yield();
+                for (size_t i = 0; i < k; ++ i) ++ seen[buf[i]];
+                remaining -= int(k);
+            }
+        });
+    }
+    for (auto &w : workers) w.join();
+    bool once = true;
+    for (int i = 0; i < 4 * n; ++ i) if (seen[i] != 1) once = false;
+    std::cout << " | " << ordered << once << std::endl;
+}
+
 int main() {
     allocatorTest();  //clear
+    allocThreadTest();
+    allocTrimTest();
+    allocStatsTest();
+    allocReallocateTest();
+    allocHugePageTest();
+    allocAlignTest();
+    allocDebugTest();
+    arenaTest();
+    statefulAllocatorTest();
     vectorTest();     //clear
     listTest();       //clear
     dequeTest();      //clear
+    dequeBlockTest();
+    dequeSegmentTest();
     queueTest();       //clear
     stackTest();      //clear
     priority_queueTest(); //clear
     rb_tree_test();     //clear
     hashTest();       //clear
     algorithmTest();    //clear
+    moveTest();
+    relocateTest();
+    uninitializedTest();
+    smallVectorTest();
+    vectorGrowthTest();
+    vectorRangeTest();
+    soaVectorTest();
+    mmapVectorTest();
+    dynamicBitsetTest();
+    workStealingDequeTest();
+    circularBufferTest();
+    concurrentQueueTest();
     return 0;
 }
@@ -5,13 +5,38 @@
 #include "functional.h"
 #include "type_traits.h"
 #include <cstring>
+#include <utility>
+#include <type_traits>
 
 namespace STL {
     /**         fill()          **/
     template<class ForwardIterator, class T>
-    void fill(ForwardIterator first, ForwardIterator last, const T& value) {
+    void fill(ForwardIterator first, ForwardIterator last, const T& value);
+
+    template<class ForwardIterator, class T>
+    void __fill(ForwardIterator first, ForwardIterator last, const T& value, std::false_type) {
+        //标量先复制一份，否则value可能指向区间内，每次写入后都要重新读取，循环无法向量化
+        typename std::conditional<std::is_scalar<T>::value, const T, const T&>::type v = value;
         for (; first != last; ++ first)
-            *first = value;
+            *first = v;
+    }
+    //分段迭代器：每段是一对指针，内层循环没有换段检查，可以被向量化
+    template<class SegmentedIterator, class T>
+    void __fill(SegmentedIterator first, SegmentedIterator last, const T& value, std::true_type) {
+        typedef segmented_iterator_traits<SegmentedIterator> traits;
+        typename traits::segment_iterator sf = traits::segment(first), sl = traits::segment(last);
+        if (sf == sl) {
+            STL::fill(traits::local(first), traits::local(last), value);
+            return;
+        }
+        STL::fill(traits::local(first), traits::end(sf), value);
+        for (++ sf; sf != sl; ++ sf)
+            STL::fill(traits::begin(sf), traits::end(sf), value);
+        STL::fill(traits::begin(sl), traits::local(last), value);
+    }
+    template<class ForwardIterator, class T>
+    void fill(ForwardIterator first, ForwardIterator last, const T& value) {
+        STL::__fill(first, last, value, typename segmented_iterator_traits<ForwardIterator>::is_segmented());
     }
     void fill(char* first, const char* last, const char& value) {
         memset(first, value, last - first);
@@ -21,12 +46,26 @@ namespace STL {
     }
     /**         fill_n()          **/
     template<class ForwardIterator, class Size, class T>
+    ForwardIterator __fill_n(ForwardIterator first, Size n, const T& value, std::false_type) {
+        typename std::conditional<std::is_scalar<T>::value, const T, const T&>::type v = value;
+        for (; n > 0; -- n, ++ first)
+            *first = v;
+        return first;
+    }
+    //分段迭代器都能随机访问，算出终点后按段填充
+    template<class SegmentedIterator, class Size, class T>
+    SegmentedIterator __fill_n(SegmentedIterator first, Size n, const T& value, std::true_type) {
+        if (n <= 0) return first;
+        SegmentedIterator last = first;
+        STL::advance(last, n);
+        STL::__fill(first, last, value, std::true_type());
+        return last;
+    }
+    template<class ForwardIterator, class Size, class T>
     ForwardIterator fill_n(ForwardIterator first,
                            Size n,
                            const T& value) {
-        for (; n > 0; -- n, ++ first)
-            *first = value;
-        return first;
+        return STL::__fill_n(first, n, value, typename segmented_iterator_traits<ForwardIterator>::is_segmented());
     }
     template<class Size>
     char* fill_n(char* first, const Size& n, const char& value) {
@@ -49,12 +88,104 @@ namespace STL {
     }
     /**         copy()          **/
     template<class InputIterator, class ForwardIterator>
-    ForwardIterator copy(InputIterator first, InputIterator last, ForwardIterator d_first) {
+    ForwardIterator copy(InputIterator first, InputIterator last, ForwardIterator d_first);
+
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator __copy_elements(InputIterator first, InputIterator last, ForwardIterator d_first) {
         while (first != last) {
             *d_first ++ = *first ++;
         }
         return d_first;
     }
+    //源区间分段：逐段交给copy，目的是指针时就是memmove
+    template<class SegmentedIterator, class ForwardIterator, class DestSegmented, class Category>
+    ForwardIterator __copy(SegmentedIterator first, SegmentedIterator last, ForwardIterator d_first,
+                           std::true_type, DestSegmented, Category) {
+        typedef segmented_iterator_traits<SegmentedIterator> traits;
+        typename traits::segment_iterator sf = traits::segment(first), sl = traits::segment(last);
+        if (sf == sl) return STL::copy(traits::local(first), traits::local(last), d_first);
+        d_first = STL::copy(traits::local(first), traits::end(sf), d_first);
+        for (++ sf; sf != sl; ++ sf)
+            d_first = STL::copy(traits::begin(sf), traits::end(sf), d_first);
+        return STL::copy(traits::begin(sl), traits::local(last), d_first);
+    }
+    //只有目的区间分段：源区间能随机访问时按目的段的剩余空间切块
+    template<class RandomIterator, class SegmentedIterator>
+    SegmentedIterator __copy(RandomIterator first, RandomIterator last, SegmentedIterator d_first,
+                             std::false_type, std::true_type, random_access_iterator_tag) {
+        typedef segmented_iterator_traits<SegmentedIterator> traits;
+        typename traits::segment_iterator seg = traits::segment(d_first);
+        typename traits::local_iterator cur = traits::local(d_first);
+        for (;;) {
+            ptrdiff_t n = last - first, room = traits::end(seg) - cur;
+            if (n <= room) return traits::compose(seg, STL::copy(first, last, cur));
+            STL::copy(first, first + room, cur);
+            first += room;
+            cur = traits::begin(++ seg);
+        }
+    }
+    template<class InputIterator, class ForwardIterator, class DestSegmented, class Category>
+    ForwardIterator __copy(InputIterator first, InputIterator last, ForwardIterator d_first,
+                           std::false_type, DestSegmented, Category) {
+        return __copy_elements(first, last, d_first);
+    }
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator copy(InputIterator first, InputIterator last, ForwardIterator d_first) {
+        return STL::__copy(first, last, d_first,
+                      typename segmented_iterator_traits<InputIterator>::is_segmented(),
+                      typename segmented_iterator_traits<ForwardIterator>::is_segmented(),
+                      typename iterator_traits<InputIterator>::iterator_category());
+    }
+    /**         move()          **/
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator move(InputIterator first, InputIterator last, ForwardIterator d_first) {
+        while (first != last) {
+            *d_first ++ = std::move(*first ++);
+        }
+        return d_first;
+    }
+    /**         move_backward()          **/
+    template< class BidirIt1, class BidirIt2 >
+    BidirIt2 move_backward(BidirIt1 first, BidirIt1 last, BidirIt2 d_last){
+        while (first != last) {
+            *(--d_last) = std::move(*(--last));
+        }
+        return d_last;
+    }
+
+    /*
+     * 指针区间上可平凡复制的元素，复制与移动没有区别，整段交给memmove(允许重叠)
+     * 比泛型版本更特化，满足条件时重载决议会选中它们
+     */
+    template<class T>
+    typename std::enable_if<std::is_trivially_copyable<T>::value, T*>::type
+    copy(const T* first, const T* last, T* d_first) {
+        const size_t n = last - first;
+        if (n != 0) memmove(d_first, first, n * sizeof(T));
+        return d_first + n;
+    }
+    template<class T>
+    typename std::enable_if<std::is_trivially_copyable<T>::value, T*>::type
+    copy(T* first, T* last, T* d_first) {
+        return STL::copy(static_cast<const T*>(first), static_cast<const T*>(last), d_first);
+    }
+    template<class T>
+    typename std::enable_if<std::is_trivially_copyable<T>::value, T*>::type
+    copy_backward(T* first, T* last, T* d_last) {
+        const size_t n = last - first;
+        if (n != 0) memmove(d_last - n, first, n * sizeof(T));
+        return d_last - n;
+    }
+    template<class T>
+    typename std::enable_if<std::is_trivially_copyable<T>::value, T*>::type
+    move(T* first, T* last, T* d_first) {
+        return STL::copy(static_cast<const T*>(first), static_cast<const T*>(last), d_first);
+    }
+    template<class T>
+    typename std::enable_if<std::is_trivially_copyable<T>::value, T*>::type
+    move_backward(T* first, T* last, T* d_last) {
+        return STL::copy_backward(first, last, d_last);
+    }
 
     /**         max()          **/
     template <class T>
@@ -67,26 +198,99 @@ namespace STL {
 	}
 	/**     find()          **/
     template<class InputIterator,class T>
-    InputIterator find(InputIterator first, InputIterator last, const T& value) {
+    InputIterator __find(InputIterator first, InputIterator last, const T& value, std::false_type) {
         while (first != last&&*first != value) {
             ++first;
         }
         return first;
     }
+    template<class SegmentedIterator, class T>
+    SegmentedIterator __find(SegmentedIterator first, SegmentedIterator last, const T& value, std::true_type) {
+        typedef segmented_iterator_traits<SegmentedIterator> traits;
+        typename traits::segment_iterator sf = traits::segment(first), sl = traits::segment(last);
+        if (sf == sl) {
+            typename traits::local_iterator p = STL::__find(traits::local(first), traits::local(last), value, std::false_type());
+            return p == traits::local(last) ? last : traits::compose(sf, p);
+        }
+        typename traits::local_iterator p = STL::__find(traits::local(first), traits::end(sf), value, std::false_type());
+        if (p != traits::end(sf)) return traits::compose(sf, p);
+        for (++ sf; sf != sl; ++ sf) {
+            p = STL::__find(traits::begin(sf), traits::end(sf), value, std::false_type());
+            if (p != traits::end(sf)) return traits::compose(sf, p);
+        }
+        p = STL::__find(traits::begin(sl), traits::local(last), value, std::false_type());
+        return p == traits::local(last) ? last : traits::compose(sl, p);
+    }
+    template<class InputIterator,class T>
+    InputIterator find(InputIterator first, InputIterator last, const T& value) {
+        return STL::__find(first, last, value, typename segmented_iterator_traits<InputIterator>::is_segmented());
+    }
+    /**     count()          **/
+    template<class InputIterator, class T>
+    size_t __count(InputIterator first, InputIterator last, const T& value, std::false_type) {
+        size_t n = 0;
+        for (; first != last; ++ first)
+            if (*first == value) ++ n;
+        return n;
+    }
+    template<class SegmentedIterator, class T>
+    size_t __count(SegmentedIterator first, SegmentedIterator last, const T& value, std::true_type) {
+        typedef segmented_iterator_traits<SegmentedIterator> traits;
+        typename traits::segment_iterator sf = traits::segment(first), sl = traits::segment(last);
+        if (sf == sl) return STL::__count(traits::local(first), traits::local(last), value, std::false_type());
+        size_t n = STL::__count(traits::local(first), traits::end(sf), value, std::false_type());
+        for (++ sf; sf != sl; ++ sf)
+            n += STL::__count(traits::begin(sf), traits::end(sf), value, std::false_type());
+        return n + STL::__count(traits::begin(sl), traits::local(last), value, std::false_type());
+    }
+    template<class InputIterator, class T>
+    size_t count(InputIterator first, InputIterator last, const T& value) {
+        return STL::__count(first, last, value, typename segmented_iterator_traits<InputIterator>::is_segmented());
+    }
+    /**     for_each()          **/
+    //f按引用传入，逐段调用时状态连续，lambda不可赋值也没关系
+    template<class InputIterator, class Function>
+    void __for_each_aux(InputIterator first, InputIterator last, Function& f) {
+        for (; first != last; ++ first)
+            f(*first);
+    }
+    template<class InputIterator, class Function>
+    Function __for_each(InputIterator first, InputIterator last, Function f, std::false_type) {
+        STL::__for_each_aux(first, last, f);
+        return f;
+    }
+    template<class SegmentedIterator, class Function>
+    Function __for_each(SegmentedIterator first, SegmentedIterator last, Function f, std::true_type) {
+        typedef segmented_iterator_traits<SegmentedIterator> traits;
+        typename traits::segment_iterator sf = traits::segment(first), sl = traits::segment(last);
+        if (sf == sl) {
+            STL::__for_each_aux(traits::local(first), traits::local(last), f);
+            return f;
+        }
+        STL::__for_each_aux(traits::local(first), traits::end(sf), f);
+        for (++ sf; sf != sl; ++ sf)
+            STL::__for_each_aux(traits::begin(sf), traits::end(sf), f);
+        STL::__for_each_aux(traits::begin(sl), traits::local(last), f);
+        return f;
+    }
+    template<class InputIterator, class Function>
+    Function for_each(InputIterator first, InputIterator last, Function f) {
+        return STL::__for_each(first, last, std::move(f), typename segmented_iterator_traits<InputIterator>::is_segmented());
+    }
     /**         accumulate      **/
     template<class InputIterator, class T>
-    InputIterator find(InputIterator first, InputIterator last, T init) {
+    T accumulate(InputIterator first, InputIterator last, T init) {
         for (; first != last; ++first) {
             init = init + *first;
         }
         return init;
     }
-	/**         swap() (c++98)      **/
+	/**         swap()      **/
 	template <class T>
 	void swap(T& a, T& b) {
-	    T tmp = a;
-	    a = b;
-	    b = tmp;
+	    T tmp = std::move(a);
+	    a = std::move(b);
+	    b = std::move(tmp);
 	}
     template <class FIter1, class FIter2>
     void iter_swap(FIter1 lhs, FIter2 rhs)
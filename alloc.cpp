@@ -1,72 +1,581 @@
 #include "alloc.h"
 #include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <new>
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+#ifdef MY_TINY_STL_ALLOC_STATS
+#define STL_ALLOC_STAT(expr) expr
+#else
+#define STL_ALLOC_STAT(expr)
+#endif
+
 namespace STL {
     char* alloc::start_free = nullptr;
     char* alloc::end_free = nullptr;
     size_t alloc::heap_size = 0;
+    size_t alloc::depot_free_bytes = 0;
+    size_t alloc::trim_threshold = 0;
+    size_t alloc::trim_trigger = 0;
+    size_t alloc::reclaimed_bytes = 0;
+#ifdef MY_TINY_STL_ALLOC_HUGE_PAGES
+    bool alloc::use_huge_pages = true;
+#else
+    bool alloc::use_huge_pages = false;
+#endif
+    size_t alloc::huge_bytes = 0;
 
-    alloc::obj* alloc::free_list[alloc::__NFREELISTS] = {
-            nullptr, nullptr, nullptr, nullptr,
-            nullptr, nullptr, nullptr, nullptr,
-            nullptr,nullptr, nullptr, nullptr,
-            nullptr, nullptr, nullptr, nullptr,
-    };
+    alloc::chunk_record* alloc::chunks = nullptr;
+    size_t alloc::chunk_count = 0;
+    size_t alloc::chunk_capacity = 0;
+
+    alloc::obj* alloc::free_list[alloc::__NFREELISTS] = { nullptr };
+    std::mutex alloc::depot_mutex;
+    thread_local alloc::thread_cache alloc::cache;
+
+#ifdef MY_TINY_STL_ALLOC_STATS
+    alloc::thread_cache* alloc::live_caches = nullptr;
+    size_t alloc::retired_allocs[alloc::__NFREELISTS] = { 0 };
+    size_t alloc::retired_frees[alloc::__NFREELISTS] = { 0 };
+    size_t alloc::refill_count[alloc::__NFREELISTS] = { 0 };
+    size_t alloc::depot_out[alloc::__NFREELISTS] = { 0 };
+    size_t alloc::depot_in[alloc::__NFREELISTS] = { 0 };
+    size_t alloc::chunk_alloc_count = 0;
+    size_t alloc::chunk_map_count = 0;
+    std::atomic<size_t> alloc::large_allocs(0);
+    std::atomic<size_t> alloc::large_frees(0);
+
+    //单写者计数，不需要原子的读改写
+    static inline void bump(std::atomic<size_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+#endif
+
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+    alloc::debug_header* alloc::debug_live = nullptr;
+    size_t alloc::debug_live_count = 0;
+    size_t alloc::debug_live_bytes = 0;
+    bool alloc::debug_report_registered = false;
+    std::mutex alloc::debug_mutex;
+#endif
+
+    alloc::thread_cache::thread_cache() {
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            free_list[i] = nullptr;
+            count[i] = 0;
+        }
+#ifdef MY_TINY_STL_ALLOC_STATS
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            allocs[i].store(0, std::memory_order_relaxed);
+            frees[i].store(0, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        prev = nullptr;
+        next = live_caches;
+        if (live_caches) live_caches->prev = this;
+        live_caches = this;
+#endif
+    }
+
+    alloc::thread_cache::~thread_cache() {
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            flush(*this, i, count[i]);
+        }
+#ifdef MY_TINY_STL_ALLOC_STATS
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            retired_allocs[i] += allocs[i].load(std::memory_order_relaxed);
+            retired_frees[i] += frees[i].load(std::memory_order_relaxed);
+        }
+        if (prev) prev->next = next;
+        else live_caches = next;
+        if (next) next->prev = prev;
+#endif
+    }
 
     size_t alloc::ROUND_UP(const size_t & bytes) {
         return ((bytes + __ALIGN - 1) & ~(__ALIGN - 1));
     }
 
+    //bytes > 1时，bytes - 1的最高位
+    static inline size_t high_bit(size_t n) {
+#if defined(__GNUC__)
+        return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(n);
+#else
+        size_t k = 0;
+        while (n >>= 1) ++ k;
+        return k;
+#endif
+    }
+
     size_t alloc::FREELIST_INDEX(const size_t & bytes) {
-        return (((bytes) + __ALIGN - 1) / __ALIGN - 1);
+        if (bytes == 0) return 0; //0字节按最小区块处理
+        if (bytes <= __SMALL_BYTES) return (((bytes) + __ALIGN - 1) / __ALIGN - 1);
+        //bytes位于(2^k, 2^(k+1)]，该区间均分4级，每级2^(k-2)
+        size_t k = high_bit(bytes - 1);
+        return __NSMALLLISTS + (k - __alloc_log2(__SMALL_BYTES)) * 4 + ((bytes - 1 - (size_t(1) << k)) >> (k - 2));
+    }
+
+    //第index级的区块大小：前small / align级按align递增，之后每个2的幂区间均分4级
+    constexpr size_t __alloc_class_size(size_t index, size_t align, size_t small) {
+        return index < small / align ? (index + 1) * align
+             : (small << ((index - small / align) / 4)) * (4 + (index - small / align) % 4 + 1) / 4;
+    }
+
+    //大小为size的区块每批搬运slab字节以内，不超过nobjs个，至少2个
+    constexpr size_t __alloc_class_batch(size_t size, size_t slab, size_t nobjs) {
+        return slab / size >= nobjs ? nobjs : (slab / size < 2 ? 2 : slab / size);
+    }
+
+    template <size_t... I> struct __alloc_index_seq {};
+    template <size_t N, size_t... I> struct __alloc_make_seq : __alloc_make_seq<N - 1, N - 1, I...> {};
+    template <size_t... I> struct __alloc_make_seq<0, I...> { typedef __alloc_index_seq<I...> type; };
+
+    //每级的批量在编译期算好，释放路径上只查表，不做除法
+    template <size_t Align, size_t Small, size_t Slab, size_t Nobjs, class Seq> struct __alloc_batch_table;
+    template <size_t Align, size_t Small, size_t Slab, size_t Nobjs, size_t... I>
+    struct __alloc_batch_table<Align, Small, Slab, Nobjs, __alloc_index_seq<I...>> {
+        static constexpr size_t value[sizeof...(I)] = {
+            __alloc_class_batch(__alloc_class_size(I, Align, Small), Slab, Nobjs)... };
+    };
+    template <size_t Align, size_t Small, size_t Slab, size_t Nobjs, size_t... I>
+    constexpr size_t __alloc_batch_table<Align, Small, Slab, Nobjs, __alloc_index_seq<I...>>::value[sizeof...(I)];
+
+    size_t alloc::CLASS_SIZE(const size_t & index) {
+        return __alloc_class_size(index, __ALIGN, __SMALL_BYTES);
+    }
+
+    size_t alloc::CLASS_ALIGN(const size_t & size) {
+        size_t low = size & (~size + 1);
+        return low < size_t(__MAX_ALIGN) ? low : size_t(__MAX_ALIGN);
+    }
+
+    size_t alloc::ALIGNED_INDEX(const size_t & bytes, const size_t & align) {
+        if (bytes > __MAX_BYTES || align > __MAX_ALIGN) return __NFREELISTS;
+        size_t index = FREELIST_INDEX(bytes);
+        //按自然对齐，区块大小是align的倍数即满足对齐
+        while (index < __NFREELISTS && CLASS_SIZE(index) % align != 0) ++ index;
+        return index;
     }
+
+    size_t alloc::BATCH(const size_t & index) {
+        typedef __alloc_batch_table<__ALIGN, __SMALL_BYTES, __SLAB_BYTES, __NOBJS,
+                                    __alloc_make_seq<__NFREELISTS>::type> table;
+        return table::value[index];
+    }
+    void *alloc::raw_allocate(const size_t & n, const size_t & align) {
+        size_t index = align <= __ALIGN ? (n > __MAX_BYTES ? size_t(__NFREELISTS) : FREELIST_INDEX(n))
+                                        : ALIGNED_INDEX(n, align);
+        if (index < __NFREELISTS) return allocate_class(index);
+        //大于池化上界或对齐超过__MAX_ALIGN，交给系统
+        STL_ALLOC_STAT(large_allocs.fetch_add(1, std::memory_order_relaxed));
+        if (align <= __ALIGN) return malloc(n);
+        void* result;
+#ifdef _WIN32
+        result = _aligned_malloc(n, align);
+#else
+        if (posix_memalign(&result, align, n) != 0) result = nullptr;
+#endif
+        if (result == nullptr) throw std::bad_alloc();
+        return result;
+    }
+
     void *alloc::allocate(const size_t &  n) {
-        if (n > (size_t)__MAX_BYTES) {
-            return malloc(n);
-        }
-        //从16个free_list中取一个适当大小的空间
-        size_t index = FREELIST_INDEX(n);
-        obj* my_free_list = free_list[index];
-        //没有合适大小的空间， 去内存迟里取
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        return debug_allocate(n, __ALIGN);
+#else
+        return raw_allocate(n, __ALIGN);
+#endif
+    }
+
+    void *alloc::allocate(const size_t & n, const size_t & align) {
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        return debug_allocate(n, align);
+#else
+        return raw_allocate(n, align);
+#endif
+    }
+
+    void *alloc::allocate_class(const size_t & index) {
+        //从本线程缓存的free_list中取一个适当大小的空间
+        thread_cache& tc = cache;
+        STL_ALLOC_STAT(bump(tc.allocs[index]));
+        obj* my_free_list = tc.free_list[index];
+        //没有合适大小的空间， 去depot或内存池里成批取
         if (my_free_list == nullptr) {
-            void* refill_p = refill(ROUND_UP(n));
+            void* refill_p = refill(CLASS_SIZE(index));
             return refill_p;
         }
         //有可用空间，从free_list中取
-        free_list[index] = my_free_list->nxt;
+        tc.free_list[index] = my_free_list->nxt;
+        -- tc.count[index];
         return my_free_list;
     }
-    void alloc::deallocate(void *ptr, const size_t & n) {
-        if (n > __MAX_BYTES) { //大于128
-            free(ptr);
+    void alloc::raw_deallocate(void *ptr, const size_t & n, const size_t & align) {
+        size_t index = align <= __ALIGN ? (n > __MAX_BYTES ? size_t(__NFREELISTS) : FREELIST_INDEX(n))
+                                        : ALIGNED_INDEX(n, align);
+        if (index < __NFREELISTS) {
+            deallocate_class(ptr, index);
+            return;
         }
-        //回收到对应free_list中
-        size_t index = FREELIST_INDEX(n);
+        STL_ALLOC_STAT(large_frees.fetch_add(1, std::memory_order_relaxed));
+#ifdef _WIN32
+        if (align > __ALIGN) {
+            _aligned_free(ptr);
+            return;
+        }
+#endif
+        free(ptr);
+    }
+
+    void alloc::deallocate(void *ptr, const size_t & n) {
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        debug_deallocate(ptr, n, __ALIGN);
+#else
+        raw_deallocate(ptr, n, __ALIGN);
+#endif
+    }
+
+    void alloc::deallocate(void *ptr, const size_t & n, const size_t & align) {
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        debug_deallocate(ptr, n, align);
+#else
+        raw_deallocate(ptr, n, align);
+#endif
+    }
+
+    void alloc::deallocate_class(void *ptr, const size_t & index) {
+        //回收到本线程缓存对应free_list中
+        thread_cache& tc = cache;
+        STL_ALLOC_STAT(bump(tc.frees[index]));
         obj* node = static_cast<obj*>(ptr);
-        node->nxt = free_list[index];
-        free_list[index] = node;
+        node->nxt = tc.free_list[index];
+        tc.free_list[index] = node;
+        //缓存溢出，成批归还depot
+        size_t batch = BATCH(index);
+        if (++ tc.count[index] > 2 * batch) {
+            flush(tc, index, batch);
+        }
     }
 
     void *alloc::reallocate(void *ptr, const size_t & old_sz, const size_t & new_sz) {
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        return debug_reallocate(ptr, old_sz, new_sz, __ALIGN);
+#else
+        if (ptr == nullptr) return allocate(new_sz);
+        if (old_sz > __MAX_BYTES && new_sz > __MAX_BYTES) { //两边都是大区块，realloc可能直接mremap
+            void* result = realloc(ptr, new_sz);
+            if (result == nullptr) throw std::bad_alloc();
+            return result;
+        }
+        if (old_sz <= __MAX_BYTES && new_sz <= __MAX_BYTES) {
+            size_t old_index = FREELIST_INDEX(old_sz);
+            size_t new_index = FREELIST_INDEX(new_sz);
+            if (old_index == new_index) return ptr; //仍在同一级，不用动
+            if (new_index > old_index) {
+                //区块正好在内存池起点之前，且池中剩余空间足够，向后原地增长
+                char* p = static_cast<char*>(ptr);
+                std::unique_lock<std::mutex> guard(depot_mutex);
+                //新的一级要求的自然对齐可能更高，ptr不满足时不能原地变成新一级的区块
+                if (p + CLASS_SIZE(old_index) == start_free && size_t(end_free - p) >= CLASS_SIZE(new_index)
+                    && reinterpret_cast<size_t>(p) % CLASS_ALIGN(CLASS_SIZE(new_index)) == 0) {
+                    start_free = p + CLASS_SIZE(new_index);
+                    STL_ALLOC_STAT(++ depot_in[old_index]);
+                    STL_ALLOC_STAT(++ depot_out[new_index]);
+                    guard.unlock();
+                    STL_ALLOC_STAT(bump(cache.frees[old_index]));
+                    STL_ALLOC_STAT(bump(cache.allocs[new_index]));
+                    return ptr;
+                }
+            }
+        }
+        void* result = allocate(new_sz);
+        memcpy(result, ptr, old_sz < new_sz ? old_sz : new_sz);
         deallocate(ptr, old_sz);
-        ptr = allocate(new_sz);
-        return ptr;
+        return result;
+#endif
+    }
+
+    void *alloc::reallocate(void *ptr, const size_t & old_sz, const size_t & new_sz, const size_t & align) {
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        return debug_reallocate(ptr, old_sz, new_sz, align);
+#else
+        if (align <= __ALIGN) return reallocate(ptr, old_sz, new_sz);
+        if (ptr == nullptr) return allocate(new_sz, align);
+        size_t old_index = ALIGNED_INDEX(old_sz, align);
+        if (old_index < __NFREELISTS && old_index == ALIGNED_INDEX(new_sz, align)) return ptr;
+        void* result = allocate(new_sz, align);
+        memcpy(result, ptr, old_sz < new_sz ? old_sz : new_sz);
+        deallocate(ptr, old_sz, align);
+        return result;
+#endif
+    }
+
+    size_t alloc::usable_size(const size_t & bytes) {
+        return usable_size(bytes, __ALIGN);
+    }
+
+    size_t alloc::usable_size(const size_t & bytes, const size_t & align) {
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        (void)align;
+        return bytes; //调试模式按请求的大小检查越界，不把零头交出去
+#else
+        size_t index = align <= __ALIGN ? (bytes > __MAX_BYTES ? size_t(__NFREELISTS) : FREELIST_INDEX(bytes))
+                                        : ALIGNED_INDEX(bytes, align);
+        return index < __NFREELISTS ? CLASS_SIZE(index) : bytes;
+#endif
+    }
+
+    void alloc::flush_thread_cache() {
+        thread_cache& tc = cache;
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            flush(tc, i, tc.count[i]);
+        }
+    }
+
+    void alloc::flush(thread_cache& tc, const size_t & index, size_t n) {
+        if (n == 0) return;
+        //在锁外找到要归还的链段[first, last]
+        obj* first = tc.free_list[index];
+        obj* last = first;
+        for (size_t i = 1; i < n; ++ i) {
+            last = last->nxt;
+        }
+        tc.free_list[index] = last->nxt;
+        tc.count[index] -= n;
+
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        last->nxt = free_list[index];
+        free_list[index] = first;
+        depot_free_bytes += n * CLASS_SIZE(index);
+        STL_ALLOC_STAT(depot_in[index] += n);
+        if (trim_threshold != 0 && depot_free_bytes > trim_trigger) {
+            trim_locked();
+            trim_trigger = depot_free_bytes + trim_threshold;
+        }
+    }
+
+    size_t alloc::trim() {
+        flush_thread_cache();
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        size_t released = trim_locked();
+        trim_trigger = depot_free_bytes + trim_threshold;
+        return released;
+    }
+
+    void alloc::set_trim_threshold(const size_t & bytes) {
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        trim_threshold = bytes;
+        trim_trigger = depot_free_bytes + bytes;
+    }
+
+    size_t alloc::pool_size() {
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        return heap_size;
+    }
+
+    size_t alloc::reclaimed_size() {
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        return reclaimed_bytes;
+    }
+
+    void alloc::set_huge_pages(bool enable) {
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        use_huge_pages = enable;
+    }
+
+    bool alloc::huge_pages() {
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        return use_huge_pages;
+    }
+
+    size_t alloc::trim_locked() {
+        //统计每个chunk中的空闲字节：depot free_list中的区块 + 内存池剩余部分
+        for (size_t c = 0; c < chunk_count; ++ c) {
+            chunks[c].free_bytes = 0;
+        }
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            for (obj* p = free_list[i]; p != nullptr; p = p->nxt) {
+                size_t c = chunk_find(p);
+                if (c != chunk_count) chunks[c].free_bytes += CLASS_SIZE(i);
+            }
+        }
+        size_t pool_chunk = start_free != end_free ? chunk_find(start_free) : chunk_count;
+        if (pool_chunk != chunk_count) {
+            chunks[pool_chunk].free_bytes += end_free - start_free;
+        }
+
+        size_t released = 0;
+        for (size_t c = 0; c < chunk_count; ++ c) {
+            if (chunks[c].free_bytes == chunks[c].size) released += chunks[c].size;
+        }
+        if (released == 0) return 0;
+
+        //从free_list中摘掉属于待释放chunk的区块
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            obj** link = free_list + i;
+            while (*link != nullptr) {
+                size_t c = chunk_find(*link);
+                if (c != chunk_count && chunks[c].free_bytes == chunks[c].size) {
+                    *link = (*link)->nxt;
+                    depot_free_bytes -= CLASS_SIZE(i);
+                }
+                else {
+                    link = &(*link)->nxt;
+                }
+            }
+        }
+        if (pool_chunk != chunk_count && chunks[pool_chunk].free_bytes == chunks[pool_chunk].size) {
+            start_free = end_free = nullptr;
+        }
+        for (size_t c = chunk_count; c-- > 0; ) {
+            if (chunks[c].free_bytes == chunks[c].size) chunk_unmap(c);
+        }
+        heap_size -= released;
+        reclaimed_bytes += released;
+        return released;
+    }
+
+    char *alloc::chunk_map(const size_t & bytes) {
+        if (chunk_count == chunk_capacity) {
+            size_t new_capacity = chunk_capacity == 0 ? 64 : chunk_capacity * 2;
+            void* p = realloc(chunks, new_capacity * sizeof(chunk_record));
+            if (p == nullptr) return nullptr;
+            chunks = static_cast<chunk_record*>(p);
+            chunk_capacity = new_capacity;
+        }
+        bool huge = false;
+#ifdef _WIN32
+        char* base = static_cast<char*>(VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        if (base == nullptr) return nullptr;
+#else
+        char* base = use_huge_pages ? huge_map(bytes, huge) : nullptr;
+        if (base == nullptr) { //未开启大页或申请失败，退回普通页
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) return nullptr;
+            base = static_cast<char*>(p);
+        }
+#endif
+        if (huge) huge_bytes += bytes;
+        //按base升序插入
+        size_t pos = chunk_count;
+        while (pos > 0 && chunks[pos - 1].base > base) {
+            chunks[pos] = chunks[pos - 1];
+            -- pos;
+        }
+        chunks[pos].base = base;
+        chunks[pos].size = bytes;
+        chunks[pos].free_bytes = 0;
+        chunks[pos].huge = huge;
+        ++ chunk_count;
+        return base;
+    }
+
+    char *alloc::huge_map(const size_t & bytes, bool & huge) {
+        huge = false;
+#if defined(_WIN32)
+        return nullptr;
+#else
+        //多映射一个大页，再把首尾不对齐的部分还回去
+        size_t span = bytes + __HUGE_PAGE_SIZE;
+        void* p = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return nullptr;
+        char* raw = static_cast<char*>(p);
+        char* base = reinterpret_cast<char*>((reinterpret_cast<size_t>(raw) + __HUGE_PAGE_SIZE - 1)
+                                             & ~(size_t(__HUGE_PAGE_SIZE) - 1));
+        if (base != raw) munmap(raw, base - raw);
+        if (raw + span != base + bytes) munmap(base + bytes, raw + span - (base + bytes));
+#ifdef MADV_HUGEPAGE
+        //内核不支持透明大页时madvise失败，这块内存照常以普通页使用
+        huge = madvise(base, bytes, MADV_HUGEPAGE) == 0;
+#endif
+        return base;
+#endif
+    }
+
+    void alloc::chunk_unmap(const size_t & pos) {
+        if (chunks[pos].huge) huge_bytes -= chunks[pos].size;
+#ifdef _WIN32
+        VirtualFree(chunks[pos].base, 0, MEM_RELEASE);
+#else
+        munmap(chunks[pos].base, chunks[pos].size);
+#endif
+        memmove(chunks + pos, chunks + pos + 1, (chunk_count - pos - 1) * sizeof(chunk_record));
+        -- chunk_count;
+    }
+
+    size_t alloc::chunk_find(const void* ptr) {
+        const char* p = static_cast<const char*>(ptr);
+        size_t lo = 0, hi = chunk_count;
+        //找最后一个base <= p的chunk
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (chunks[mid].base <= p) lo = mid + 1;
+            else hi = mid;
+        }
+        if (lo == 0 || p >= chunks[lo - 1].base + chunks[lo - 1].size) return chunk_count;
+        return lo - 1;
+    }
+
+    void alloc::put_back(char *ptr, size_t bytes) {
+        //从大到小切成恰好等于某一级大小、且地址满足该级自然对齐的区块，8字节一级总能满足
+        while (bytes >= __ALIGN) {
+            size_t index = FREELIST_INDEX(bytes);
+            if (CLASS_SIZE(index) > bytes) -- index;
+            while (index > 0 && reinterpret_cast<size_t>(ptr) % CLASS_ALIGN(CLASS_SIZE(index)) != 0) -- index;
+            size_t size = CLASS_SIZE(index);
+            ((obj *)ptr)->nxt = free_list[index];
+            free_list[index] = (obj *)ptr;
+            depot_free_bytes += size;
+            ptr += size;
+            bytes -= size;
+        }
     }
 
     void *alloc::refill(const size_t & n) {
-        //n保证是8的倍数
-        size_t nobjs = 20;
-        char* chunk = chunk_alloc(n, nobjs);
-        obj** my_free_list;
+        //n保证是某一级区块的大小
+        size_t index = FREELIST_INDEX(n);
+        size_t batch = BATCH(index);
+        size_t nobjs = batch;
         obj* result;
         obj* current_obj, *next_obj;
+        thread_cache& tc = cache;
+
+        std::unique_lock<std::mutex> guard(depot_mutex);
+        STL_ALLOC_STAT(++ refill_count[index]);
+        //depot中有空闲区块，整批搬到线程缓存
+        if (free_list[index] != nullptr) {
+            result = free_list[index];
+            current_obj = result;
+            for (nobjs = 1; nobjs < batch && current_obj->nxt != nullptr; ++ nobjs) {
+                current_obj = current_obj->nxt;
+            }
+            free_list[index] = current_obj->nxt;
+            depot_free_bytes -= nobjs * n;
+            STL_ALLOC_STAT(depot_out[index] += nobjs);
+            guard.unlock();
+
+            current_obj->nxt = nullptr;
+            tc.free_list[index] = result->nxt;
+            tc.count[index] = nobjs - 1;
+            return result;
+        }
+        char* chunk = chunk_alloc(n, nobjs);
+        STL_ALLOC_STAT(depot_out[index] += nobjs);
+        guard.unlock();
 
         if (nobjs == 1) return chunk;
 
-        my_free_list = free_list + FREELIST_INDEX(n);
         result = (obj*) (chunk);
-        *my_free_list = next_obj = (obj* )(chunk + n);
-        //将取多的空间放到对应free_list里
-        for (int i = 1; ; ++ i) {
+        tc.free_list[index] = next_obj = (obj* )(chunk + n);
+        tc.count[index] = nobjs - 1;
+        //将取多的空间放到线程缓存对应free_list里
+        for (size_t i = 1; ; ++ i) {
             current_obj = next_obj;
             next_obj = (obj* )((char *)next_obj + n);
             if (nobjs - 1 == i) {
@@ -83,38 +592,41 @@ namespace STL {
     char *alloc::chunk_alloc(const size_t & bytes, size_t &nobjs) {
         char* result;
         size_t need_bytes = bytes * nobjs;
-        size_t bytes_left = end_free - start_free;
+        //区块按自然对齐切分，对齐跳过的部分放回depot
+        size_t align = CLASS_ALIGN(bytes);
+        char* aligned = reinterpret_cast<char*>((reinterpret_cast<size_t>(start_free) + align - 1) & ~(align - 1));
+        size_t bytes_left = aligned < end_free ? end_free - aligned : 0;
+        STL_ALLOC_STAT(++ chunk_alloc_count);
 
-        if (bytes_left >= need_bytes) { //内存池剩余大小满足需要
-            result = start_free;
-            start_free = start_free + need_bytes;
-            return result;
-        }
-        else if (bytes_left >= bytes) {  //只能满足一个以上的需要
-            nobjs = bytes_left / bytes;
-            need_bytes = nobjs * bytes;
-            result = start_free;
-            start_free += need_bytes;
+        if (bytes_left >= bytes) {
+            if (bytes_left < need_bytes) { //只能满足一个以上的需要
+                nobjs = bytes_left / bytes;
+                need_bytes = nobjs * bytes;
+            }
+            put_back(start_free, aligned - start_free);
+            result = aligned;
+            start_free = aligned + need_bytes;
             return result;
         }
         else { //内存池连一个都无法满足
-            if (bytes_left > 0) {
-                obj ** my_free_list = free_list + FREELIST_INDEX(bytes_left);
-                ((obj *)start_free)->nxt = *my_free_list;
-                *my_free_list = (obj *)start_free;
+            if (end_free != start_free) {
+                put_back(start_free, end_free - start_free);
             }
             size_t bytes_to_get = 2 * need_bytes + ROUND_UP(heap_size >> 4);
-            start_free = (char *) malloc(bytes_to_get);
-            if (start_free == nullptr) { //malloc找不斗空间，寻找大小相近的空间
+            size_t granule = use_huge_pages ? size_t(__HUGE_PAGE_SIZE) : size_t(__PAGE_SIZE);
+            bytes_to_get = (bytes_to_get + granule - 1) & ~(granule - 1);
+            start_free = chunk_map(bytes_to_get);
+            if (start_free == nullptr) { //系统找不到空间，寻找大小相近的空间
                 obj** my_free_list;
                 obj* ptr;
-                for (size_t i = bytes; i <= __MAX_BYTES; i += __ALIGN) {
-                    my_free_list = free_list + FREELIST_INDEX(i);
+                for (size_t i = FREELIST_INDEX(bytes); i < __NFREELISTS; ++ i) {
+                    my_free_list = free_list + i;
                     ptr = *my_free_list;
                     if (ptr != nullptr) {
                         *my_free_list = ptr->nxt;
+                        depot_free_bytes -= CLASS_SIZE(i);
                         start_free = (char *)ptr;
-                        end_free = start_free + i;
+                        end_free = start_free + CLASS_SIZE(i);
                         return chunk_alloc(bytes, nobjs);
                     }
                 }
@@ -122,6 +634,7 @@ namespace STL {
                 throw std::bad_alloc();
             }
             heap_size += bytes_to_get;
+            STL_ALLOC_STAT(++ chunk_map_count);
             end_free = start_free + bytes_to_get;
             return chunk_alloc(bytes, nobjs);
 
@@ -129,5 +642,189 @@ namespace STL {
     }
 
 
-}
+    alloc::stats alloc::get_stats() {
+        stats st;
+        memset(&st, 0, sizeof(st));
+        std::lock_guard<std::mutex> guard(depot_mutex);
+        st.pool_bytes = heap_size;
+        st.huge_pages = use_huge_pages;
+        st.huge_page_bytes = huge_bytes;
+        st.reclaimed_bytes = reclaimed_bytes;
+        st.pool_window_bytes = end_free - start_free;
+        st.depot_free_bytes = depot_free_bytes;
+        st.class_count = __NFREELISTS;
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            class_stats& cs = st.classes[i];
+            cs.size = CLASS_SIZE(i);
+            for (obj* p = free_list[i]; p != nullptr; p = p->nxt) ++ cs.depot;
+        }
+#ifdef MY_TINY_STL_ALLOC_STATS
+        st.enabled = true;
+        st.chunk_allocs = chunk_alloc_count;
+        st.system_chunks = chunk_map_count;
+        st.large_allocs = large_allocs.load(std::memory_order_relaxed);
+        st.large_frees = large_frees.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < __NFREELISTS; ++ i) {
+            class_stats& cs = st.classes[i];
+            cs.allocs = retired_allocs[i];
+            cs.frees = retired_frees[i];
+            for (thread_cache* tc = live_caches; tc != nullptr; tc = tc->next) {
+                cs.allocs += tc->allocs[i].load(std::memory_order_relaxed);
+                cs.frees += tc->frees[i].load(std::memory_order_relaxed);
+            }
+            //各线程的计数读取时刻不同，差值可能短暂为负
+            cs.live = cs.allocs > cs.frees ? cs.allocs - cs.frees : 0;
+            size_t outside = depot_out[i] - depot_in[i];
+            cs.cached = outside > cs.live ? outside - cs.live : 0;
+            cs.refills = refill_count[i];
+            st.in_use_bytes += cs.live * cs.size;
+            st.cached_bytes += cs.cached * cs.size;
+        }
+#endif
+        return st;
+    }
+
+    void alloc::print_stats(std::ostream& os) {
+        stats st = get_stats();
+        os << "pool bytes: " << st.pool_bytes << ", reclaimed: " << st.reclaimed_bytes
+           << ", pool window: " << st.pool_window_bytes << ", depot free: " << st.depot_free_bytes
+           << ", huge pages: " << (st.huge_pages ? "on" : "off") << " (" << st.huge_page_bytes << " bytes)" << std::endl;
+        if (!st.enabled) {
+            os << "(define MY_TINY_STL_ALLOC_STATS for per-class counters)" << std::endl;
+            return;
+        }
+        os << "in use: " << st.in_use_bytes << ", thread cached: " << st.cached_bytes
+           << ", chunk_alloc: " << st.chunk_allocs << ", system chunks: " << st.system_chunks
+           << ", large allocs/frees: " << st.large_allocs << "/" << st.large_frees << std::endl;
+        os << std::setw(6) << "size" << std::setw(12) << "allocs" << std::setw(12) << "frees"
+           << std::setw(10) << "live" << std::setw(10) << "cached" << std::setw(10) << "depot"
+           << std::setw(10) << "refills" << std::endl;
+        for (size_t i = 0; i < st.class_count; ++ i) {
+            const class_stats& cs = st.classes[i];
+            if (cs.allocs == 0 && cs.depot == 0) continue;
+            os << std::setw(6) << cs.size << std::setw(12) << cs.allocs << std::setw(12) << cs.frees
+               << std::setw(10) << cs.live << std::setw(10) << cs.cached << std::setw(10) << cs.depot
+               << std::setw(10) << cs.refills << std::endl;
+        }
+    }
+
+    void alloc::print_stats_json(std::ostream& os) {
+        stats st = get_stats();
+        os << "{\"enabled\":" << (st.enabled ? "true" : "false")
+           << ",\"pool_bytes\":" << st.pool_bytes
+           << ",\"huge_pages\":" << (st.huge_pages ? "true" : "false")
+           << ",\"huge_page_bytes\":" << st.huge_page_bytes
+           << ",\"reclaimed_bytes\":" << st.reclaimed_bytes
+           << ",\"pool_window_bytes\":" << st.pool_window_bytes
+           << ",\"depot_free_bytes\":" << st.depot_free_bytes
+           << ",\"cached_bytes\":" << st.cached_bytes
+           << ",\"in_use_bytes\":" << st.in_use_bytes
+           << ",\"chunk_allocs\":" << st.chunk_allocs
+           << ",\"system_chunks\":" << st.system_chunks
+           << ",\"large_allocs\":" << st.large_allocs
+           << ",\"large_frees\":" << st.large_frees
+           << ",\"classes\":[";
+        for (size_t i = 0; i < st.class_count; ++ i) {
+            const class_stats& cs = st.classes[i];
+            if (i) os << ",";
+            os << "{\"size\":" << cs.size << ",\"allocs\":" << cs.allocs << ",\"frees\":" << cs.frees
+               << ",\"live\":" << cs.live << ",\"cached\":" << cs.cached << ",\"depot\":" << cs.depot
+               << ",\"refills\":" << cs.refills << "}";
+        }
+        os << "]}" << std::endl;
+    }
+
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+    //区块尾部的金丝雀，按字节写入，不要求对齐
+    static const unsigned char debug_tail[] = { 0xC0, 0xFF, 0xEE, 0x5A, 0xA5, 0x0B, 0xAD, 0x1D };
 
+    static void debug_report_at_exit() {
+        alloc::report_leaks(std::cerr);
+    }
+
+    void alloc::debug_fail(const char* what, const void* ptr, const size_t & bytes) {
+        std::cerr << "STL::alloc: " << what << " at " << ptr << " (" << bytes << " bytes)" << std::endl;
+        abort();
+    }
+
+    void *alloc::debug_allocate(const size_t & n, const size_t & align) {
+        size_t head = align > __DEBUG_HEAD ? align : size_t(__DEBUG_HEAD);
+        char* user = static_cast<char*>(raw_allocate(n + head + __DEBUG_TAIL, align)) + head;
+        debug_header* h = reinterpret_cast<debug_header*>(user) - 1;
+        h->bytes = n;
+        h->align = static_cast<unsigned int>(align);
+        h->magic = __DEBUG_LIVE;
+        memset(user, 0xCD, n); //未初始化的内容填成固定值，读到它说明用了未构造的内存
+        memcpy(user + n, debug_tail, __DEBUG_TAIL);
+
+        std::lock_guard<std::mutex> guard(debug_mutex);
+        h->prev = nullptr;
+        h->next = debug_live;
+        if (debug_live) debug_live->prev = h;
+        debug_live = h;
+        ++ debug_live_count;
+        debug_live_bytes += n;
+        if (!debug_report_registered) {
+            debug_report_registered = true;
+            atexit(debug_report_at_exit);
+        }
+        return user;
+    }
+
+    void alloc::debug_deallocate(void *ptr, const size_t & n, const size_t & align) {
+        if (ptr == nullptr) return;
+        char* user = static_cast<char*>(ptr);
+        debug_header* h = reinterpret_cast<debug_header*>(user) - 1;
+        if (h->magic == __DEBUG_FREED) debug_fail("double free", ptr, n);
+        if (h->magic != __DEBUG_LIVE) debug_fail("corrupted header canary or pointer not from alloc", ptr, n);
+        size_t head = align > __DEBUG_HEAD ? align : size_t(__DEBUG_HEAD);
+        //按错误的大小或对齐释放会把区块挂到别的free_list上
+        if (h->align != align ||
+            ALIGNED_INDEX(h->bytes + head + __DEBUG_TAIL, align > __ALIGN ? align : size_t(__ALIGN)) !=
+            ALIGNED_INDEX(n + head + __DEBUG_TAIL, align > __ALIGN ? align : size_t(__ALIGN)))
+            debug_fail("deallocate size/alignment does not match allocate", ptr, n);
+        if (memcmp(user + h->bytes, debug_tail, __DEBUG_TAIL) != 0)
+            debug_fail("buffer overflow past the end of block", ptr, h->bytes);
+
+        size_t bytes = h->bytes;
+        {
+            std::lock_guard<std::mutex> guard(debug_mutex);
+            if (h->prev) h->prev->next = h->next;
+            else debug_live = h->next;
+            if (h->next) h->next->prev = h->prev;
+            -- debug_live_count;
+            debug_live_bytes -= bytes;
+        }
+        h->magic = __DEBUG_FREED;
+        memset(user, 0xDD, bytes); //释放后仍被读写的内容一眼可见
+        raw_deallocate(user - head, bytes + head + __DEBUG_TAIL, align);
+    }
+
+    void *alloc::debug_reallocate(void *ptr, const size_t & old_sz, const size_t & new_sz, const size_t & align) {
+        //调试模式不原地增长，总是换一块新区块，让旧指针的误用暴露出来
+        void* result = debug_allocate(new_sz, align);
+        if (ptr != nullptr) {
+            memcpy(result, ptr, old_sz < new_sz ? old_sz : new_sz);
+            debug_deallocate(ptr, old_sz, align);
+        }
+        return result;
+    }
+#endif
+
+    size_t alloc::report_leaks(std::ostream& os) {
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        std::lock_guard<std::mutex> guard(debug_mutex);
+        if (debug_live_count == 0) return 0;
+        os << "STL::alloc: " << debug_live_count << " blocks (" << debug_live_bytes << " bytes) still allocated" << std::endl;
+        size_t shown = 0;
+        for (debug_header* h = debug_live; h != nullptr && shown < 16; h = h->next, ++ shown) {
+            os << "  " << static_cast<void*>(h + 1) << " " << h->bytes << " bytes" << std::endl;
+        }
+        if (debug_live_count > shown) os << "  ..." << std::endl;
+        return debug_live_count;
+#else
+        (void)os;
+        return 0;
+#endif
+    }
+}
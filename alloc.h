@@ -1,41 +1,255 @@
 #ifndef MY_TINY_STL_ALLOC_H
 #define MY_TINY_STL_ALLOC_H
 #include <cstdlib>
+#include <mutex>
+#include <atomic>
+#include <iosfwd>
+
+/*
+ * 池化区块的上界，超过的直接交给malloc，编译期可配置，须为不小于128的2的幂
+ * 128字节以内按8字节分级，之上每个2的幂区间再均分为4级，如160,192,224,256,320,...
+ */
+#ifndef MY_TINY_STL_ALLOC_MAX_BYTES
+#define MY_TINY_STL_ALLOC_MAX_BYTES 4096
+#endif
+/*
+ * 定义MY_TINY_STL_ALLOC_HUGE_PAGES后，内存池默认按2MB对齐向系统申请chunk并建议内核使用透明大页，
+ * 减少大量节点之间指针跳转的TLB缺失；运行时也可用alloc::set_huge_pages切换
+ * 系统不支持时退回普通页，Windows下总是使用普通页
+ */
+/*
+ * 定义MY_TINY_STL_ALLOC_STATS后统计每级区块的分配/回收次数、refill与chunk_alloc次数等，
+ * 未定义时计数代码全部不参与编译，alloc::get_stats()只给出内存池层面的字节数
+ * 所有翻译单元须使用相同的设置
+ */
+/*
+ * 定义MY_TINY_STL_ALLOC_DEBUG后进入加固模式，用于测试与压测，所有翻译单元须使用相同的设置：
+ * 每个区块前加头部(记录大小、对齐与状态)，尾部加金丝雀；释放时检查头尾金丝雀、大小/对齐与分配时是否同级、
+ * 是否重复释放，出错打印原因后abort；新区块填0xCD，释放的区块填0xDD；程序退出时报告未释放的区块
+ * 调试模式下reallocate总是换新区块；未定义时以上代码全部不参与编译
+ */
 
 namespace  STL {
+    constexpr size_t __alloc_log2(size_t n) {
+        return n <= 1 ? 0 : 1 + __alloc_log2(n >> 1);
+    }
+
     /*
      * 空间配置器，以字节为单位去分配内存空间
+     * 两层结构：每个线程持有一份线程本地缓存(magazine)，allocate/deallocate只操作本线程缓存，无锁；
+     * 缓存取空或溢出时，才加锁与全局depot(全局free_list + 内存池)成批交换区块
      */
     class alloc {
     private:
         enum{ __ALIGN =  8 }; //小区块上调边界
-        enum{ __MAX_BYTES = 128 };//小型区块上界
-        enum{ __NFREELISTS = __MAX_BYTES / __ALIGN }; // free_list个数
-        enum{ __NOBJS = 20 }; //每次增加的节点数
+        enum{ __SMALL_BYTES = 128 }; //按__ALIGN分级的区块上界
+        enum{ __MAX_BYTES = MY_TINY_STL_ALLOC_MAX_BYTES };//池化区块上界
+        enum{ __NSMALLLISTS = __SMALL_BYTES / __ALIGN };
+        enum{ __NFREELISTS = __NSMALLLISTS + 4 * __alloc_log2(__MAX_BYTES / __SMALL_BYTES) }; // free_list个数
+        enum{ __NOBJS = 20 }; //每次增加的节点数，也是线程缓存与depot之间一次搬运的区块数
+        enum{ __SLAB_BYTES = 16384 }; //大区块一次搬运不超过这么多字节，至少2个
+        static_assert(size_t(__MAX_BYTES) >= size_t(__SMALL_BYTES) && (__MAX_BYTES & (__MAX_BYTES - 1)) == 0,
+                      "MY_TINY_STL_ALLOC_MAX_BYTES must be a power of two no less than 128");
+        enum{ __MAX_ALIGN = 64 }; //池化区块的自然对齐上限，更高的对齐交给系统
+        enum{ __PAGE_SIZE = 4096 }; //向系统申请chunk的粒度
+        enum{ __HUGE_PAGE_SIZE = 2 << 20 }; //使用大页时chunk的粒度与对齐
         static char* start_free; //内存池起点
         static char* end_free; //内存池终点
-        static size_t heap_size;
+        static size_t heap_size; //当前向系统持有的字节数
+        static size_t depot_free_bytes; //depot free_list中的字节数
+        static size_t trim_threshold; //depot空闲字节超过trim_trigger时自动trim，0表示关闭
+        static size_t trim_trigger;
+        static size_t reclaimed_bytes; //累计归还给系统的字节数
+        static bool use_huge_pages; //新chunk是否从透明大页申请
+        static size_t huge_bytes; //当前持有的大页chunk字节数
+
+        //向系统申请的一块chunk，free_bytes仅在trim时统计
+        struct chunk_record {
+            char* base;
+            size_t size;
+            size_t free_bytes;
+            bool huge; //是否成功建议了透明大页
+        };
+        static chunk_record* chunks; //按base升序排列
+        static size_t chunk_count;
+        static size_t chunk_capacity;
 
         union obj { //free list的节点
             union obj* nxt;
             char data[1];
         };
+        //depot：所有线程共享的free_list，与内存池一起由depot_mutex保护
         static obj* free_list[__NFREELISTS];
+        static std::mutex depot_mutex;
+
+        //线程本地缓存，每个区块大小对应一条free_list
+        struct thread_cache {
+            obj* free_list[__NFREELISTS];
+            size_t count[__NFREELISTS];
+#ifdef MY_TINY_STL_ALLOC_STATS
+            //只有本线程写，其他线程在get_stats时读
+            std::atomic<size_t> allocs[__NFREELISTS];
+            std::atomic<size_t> frees[__NFREELISTS];
+            thread_cache* prev; //所有存活的线程缓存串成链表，由depot_mutex保护
+            thread_cache* next;
+#endif
+
+            thread_cache();
+            ~thread_cache(); //线程退出时把缓存的区块全部归还depot
+        };
+        static thread_local thread_cache cache;
+
+#ifdef MY_TINY_STL_ALLOC_DEBUG
+        enum{ __DEBUG_HEAD = 32 }; //头部占用的字节数，对齐超过它时取对齐
+        enum{ __DEBUG_TAIL = 8 }; //尾部金丝雀的字节数
+        enum : unsigned int { __DEBUG_LIVE = 0xA110CA7Eu, __DEBUG_FREED = 0xDEADF7EEu };
+        //紧挨在用户指针之前，magic兼作头部金丝雀；区块在free_list中时prev会被链接指针覆盖
+        struct debug_header {
+            debug_header* prev; //未释放的区块串成链表，由debug_mutex保护
+            debug_header* next;
+            size_t bytes; //用户请求的字节数
+            unsigned int align;
+            unsigned int magic;
+        };
+        static_assert(sizeof(debug_header) <= __DEBUG_HEAD, "debug header too large");
+        static debug_header* debug_live;
+        static size_t debug_live_count;
+        static size_t debug_live_bytes;
+        static bool debug_report_registered;
+        static std::mutex debug_mutex;
+
+        static void* debug_allocate(const size_t & bytes, const size_t & align);
+        static void debug_deallocate(void *ptr, const size_t & bytes, const size_t & align);
+        static void* debug_reallocate(void *ptr, const size_t & old_sz, const size_t & new_sz, const size_t & align);
+        static void debug_fail(const char* what, const void* ptr, const size_t & bytes);
+#endif
+
+#ifdef MY_TINY_STL_ALLOC_STATS
+        //以下计数除large_*外均由depot_mutex保护
+        static thread_cache* live_caches;
+        static size_t retired_allocs[__NFREELISTS]; //已退出线程的计数
+        static size_t retired_frees[__NFREELISTS];
+        static size_t refill_count[__NFREELISTS];
+        static size_t depot_out[__NFREELISTS]; //从depot/内存池搬到线程缓存的区块数
+        static size_t depot_in[__NFREELISTS]; //从线程缓存归还depot的区块数
+        static size_t chunk_alloc_count;
+        static size_t chunk_map_count;
+        static std::atomic<size_t> large_allocs; //超过池化上界、直接malloc的次数
+        static std::atomic<size_t> large_frees;
+#endif
 
         //将bytes上调至的倍数
         static size_t ROUND_UP(const size_t & bytes) ;
         //根据区块大小，决定使用第n号free_list，从0起
         static size_t FREELIST_INDEX(const size_t & bytes) ;
-        //配置可容纳nobjs个大小为size的区块
+        //第index号free_list的区块大小
+        static size_t CLASS_SIZE(const size_t & index) ;
+        /*
+         * 大小为size的区块保证的对齐：size的最低位1，不超过__MAX_ALIGN
+         * 如24字节8对齐，48字节16对齐，192字节64对齐
+         */
+        static size_t CLASS_ALIGN(const size_t & size) ;
+        //能容纳bytes字节且满足align对齐的最小一级，没有则返回__NFREELISTS
+        static size_t ALIGNED_INDEX(const size_t & bytes, const size_t & align) ;
+        //第index号free_list每次与depot搬运的区块数，线程缓存中超过其两倍就归还一批
+        static size_t BATCH(const size_t & index) ;
+        //配置可容纳nobjs个大小为size的区块，调用者需持有depot_mutex
         static char *chunk_alloc(const size_t & size, size_t &nobjs);
 
-        //返回一个大小为n的对象，并可能加入大小为n的其他区块到free_list
+        //向系统申请/归还整页内存，并登记到chunks
+        static char* chunk_map(const size_t & bytes);
+        //按大页对齐申请bytes字节并建议使用透明大页，huge返回建议是否被接受，失败返回nullptr
+        static char* huge_map(const size_t & bytes, bool & huge);
+        static void chunk_unmap(const size_t & pos);
+        //找到ptr所在的chunk，找不到返回chunk_count
+        static size_t chunk_find(const void* ptr);
+        //把一段不再使用的内存按区块大小切开放入depot，调用者需持有depot_mutex
+        static void put_back(char* ptr, size_t bytes);
+        //统计每个chunk的空闲字节，把完全空闲的chunk还给系统，调用者需持有depot_mutex
+        static size_t trim_locked();
+
+        //不经调试检查的分配/回收，align不超过8时按普通区块
+        static void* raw_allocate(const size_t & bytes, const size_t & align) ;
+        static void raw_deallocate(void *ptr, const size_t & bytes, const size_t & align) ;
+        //从线程缓存第index号free_list取一个区块/归还一个区块
+        static void* allocate_class(const size_t & index) ;
+        static void deallocate_class(void *ptr, const size_t & index) ;
+        //返回一个大小为n的对象，并从depot或内存池搬一批大小为n的区块到线程缓存
         static void* refill(const size_t & byte) ;
+        //把线程缓存第index号free_list前n个区块归还depot
+        static void flush(thread_cache& tc, const size_t & index, size_t n);
 
     public:
+        //某一级区块的统计
+        struct class_stats {
+            size_t size;
+            size_t allocs;
+            size_t frees;
+            size_t live; //已分配出去尚未回收的区块数
+            size_t cached; //各线程缓存中的区块数
+            size_t depot; //depot free_list中的区块数
+            size_t refills;
+        };
+        //get_stats()的快照，未开启统计时只有enabled为false和内存池层面的字节数有效
+        struct stats {
+            bool enabled;
+            size_t pool_bytes; //向系统持有的字节数
+            bool huge_pages; //新chunk是否从透明大页申请
+            size_t huge_page_bytes; //pool_bytes中建议了透明大页的字节数
+            size_t reclaimed_bytes; //trim累计归还的字节数
+            size_t pool_window_bytes; //内存池中尚未切分的字节数
+            size_t depot_free_bytes; //depot free_list中的字节数
+            size_t cached_bytes; //各线程缓存中的字节数
+            size_t in_use_bytes; //已分配出去的池化字节数
+            size_t chunk_allocs;
+            size_t system_chunks; //向系统申请chunk的次数
+            size_t large_allocs;
+            size_t large_frees;
+            size_t class_count;
+            class_stats classes[__NFREELISTS];
+        };
+
         static void* allocate(const size_t & bytes) ;
         static void deallocate(void *ptr, const size_t & bytes) ;
+        /*
+         * 按align(2的幂)对齐分配，align不超过8时与上面相同
+         * 不超过64时取大小为align倍数的一级区块，更高的对齐或大区块交给系统的对齐分配
+         * 释放时须传入相同的bytes与align
+         */
+        static void* allocate(const size_t & bytes, const size_t & align) ;
+        static void deallocate(void *ptr, const size_t & bytes, const size_t & align) ;
+        /*
+         * 把ptr处old_sz字节的区块调整为new_sz字节，保留前min(old_sz, new_sz)字节的内容
+         * 同一级区块直接返回ptr；区块恰好位于内存池末端时原地增长；大区块交给realloc
+         */
         static void* reallocate(void *ptr, const size_t & old_sz, const size_t & new_sz) ;
+        static void* reallocate(void *ptr, const size_t & old_sz, const size_t & new_sz, const size_t & align) ;
+        /*
+         * 请求bytes字节(按align对齐)时实际交付的区块大小，调用者可以把整块都当作自己的，
+         * 释放和reallocate时按这个大小传入也落在同一级；交给系统的大区块和调试模式下原样返回bytes
+         */
+        static size_t usable_size(const size_t & bytes) ;
+        static size_t usable_size(const size_t & bytes, const size_t & align) ;
+        //把当前线程缓存的区块全部归还depot
+        static void flush_thread_cache();
+        /*
+         * 把完全空闲的chunk还给系统，返回本次归还的字节数
+         * 只能看到depot中的区块，其他线程缓存里的区块视为仍在使用
+         */
+        static size_t trim();
+        //depot空闲字节每增长bytes就在归还路径上自动trim一次，0表示关闭
+        static void set_trim_threshold(const size_t & bytes);
+        static size_t pool_size(); //当前向系统持有的字节数
+        static size_t reclaimed_size(); //累计归还给系统的字节数
+        //之后新申请的chunk是否使用透明大页，已有的chunk不受影响
+        static void set_huge_pages(bool enable);
+        static bool huge_pages();
+        static stats get_stats();
+        //以文本表格或JSON输出get_stats()
+        static void print_stats(std::ostream& os);
+        static void print_stats_json(std::ostream& os);
+        //调试模式下列出尚未释放的区块，返回其个数；未开启调试模式时总是返回0
+        static size_t report_leaks(std::ostream& os);
 
         alloc() = default;
         ~alloc() = default;
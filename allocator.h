@@ -4,11 +4,13 @@
 #include <new>
 #include "alloc.h"
 #include "construct.h"
+#include "allocator_traits.h"
 
 namespace STL {
     /*
      * 对alloc出来的地址进行placement new
      * 对自身构造出来的内容进行对应的析构
+     * 分配的空间满足alignof(T)，包括alignas声明的过对齐类型
      */
     template <class T>
     class allocator {
@@ -21,54 +23,82 @@ namespace STL {
         typedef size_t		size_type;
         typedef ptrdiff_t	difference_type;
 
+        //容器用rebind得到同一种配置器下其他类型(节点、指针数组)的版本
+        template <class U>
+        struct rebind {
+            typedef allocator<U> other;
+        };
+
         //分配未构造的内存空间，使用自带的alloc
         static T* allocate();
         static T* allocate(size_t n);
         static void deallocate(T* ptr);
         static void deallocate(T* ptr, size_t n);
+        //把容纳old_n个T的空间调整为new_n个，按字节搬运内容，只适用于可平凡复制的T
+        static T* reallocate(T* ptr, size_t old_n, size_t new_n);
+        //申请n个T时实际拿到的区块能放下几个T，不小于n
+        static size_t usable_size(size_t n);
 
         /*
 		**以下的构造和析构都是针对带有构造函数和析构函数的对象
 		**对于基本对象直接返回内存空间
+		**construct把参数原样转发给T的构造函数，右值参数触发移动构造
 		*/
-        static void construct(T *ptr);
-        static void construct(T *ptr, const T& value);
+        template <class... Args>
+        static void construct(T *ptr, Args&&... args);
         static void destroy(T *ptr);
         static void destroy(T *first, T *last);
 
+        //无状态，任意两个实例可以互相释放对方分配的内存
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type is_always_equal;
+
         allocator()= default;
+        template <class U>
+        allocator(const allocator<U>&) {}
         ~allocator()= default;
     };
 
+    template <class T, class U>
+    bool operator==(const allocator<T>&, const allocator<U>&) { return true; }
+    template <class T, class U>
+    bool operator!=(const allocator<T>&, const allocator<U>&) { return false; }
+
     template<class T>
      T *allocator<T>::allocate() {
-        return static_cast<T*>(alloc::allocate(sizeof(T)));
+        return static_cast<T*>(alloc::allocate(sizeof(T), alignof(T)));
     }
 
     template<class T>
     T *allocator<T>::allocate(size_t n) {
-        return static_cast<T*>(alloc::allocate(sizeof(T) * n));
+        return static_cast<T*>(alloc::allocate(sizeof(T) * n, alignof(T)));
     }
 
     template<class T>
     void allocator<T>::deallocate(T *ptr) {
-        alloc::deallocate(static_cast<void *>(ptr), sizeof(T));
+        alloc::deallocate(static_cast<void *>(ptr), sizeof(T), alignof(T));
     }
 
     template<class T>
     void allocator<T>::deallocate(T *ptr, size_t n) {
-        if (n == 0) return;
-        alloc::deallocate(static_cast<void *>(ptr), sizeof(T)* n);
+        if (ptr == nullptr) return;
+        alloc::deallocate(static_cast<void *>(ptr), sizeof(T) * n, alignof(T));
     }
 
     template<class T>
-    void allocator<T>::construct(T *ptr) { //调用default placement new
-        STL::construct(ptr, T());
+    T *allocator<T>::reallocate(T *ptr, size_t old_n, size_t new_n) {
+        return static_cast<T*>(alloc::reallocate(static_cast<void *>(ptr), sizeof(T) * old_n, sizeof(T) * new_n, alignof(T)));
     }
 
     template<class T>
-    void allocator<T>::construct(T *ptr, const T &value) { //带参调用 placement new
-        STL::construct(ptr, value);
+    size_t allocator<T>::usable_size(size_t n) {
+        return alloc::usable_size(sizeof(T) * n, alignof(T)) / sizeof(T);
+    }
+
+    template<class T>
+    template<class... Args>
+    void allocator<T>::construct(T *ptr, Args&&... args) { //转发参数调用 placement new
+        STL::construct(ptr, std::forward<Args>(args)...);
     }
 
     template<class T>
@@ -80,5 +110,102 @@ namespace STL {
     void allocator<T>::destroy(T *first, T *last) {
         STL::destroy(first, last);
     }
+
+    /*
+     * 按Align字节对齐分配的配置器，Align须为2的幂，小于alignof(T)时按alignof(T)
+     * 用于SIMD缓冲区(如aligned_allocator<float, 32>)和按缓存行隔开的每线程槽位，避免伪共享
+     * Align不超过64且区块不超过池化上界时仍走alloc的线程缓存
+     */
+    template <class T, size_t Align>
+    class aligned_allocator {
+        static_assert(Align != 0 && (Align & (Align - 1)) == 0, "Align must be a power of two");
+    public:
+        typedef T			value_type;
+        typedef T*			pointer;
+        typedef const T*	const_pointer;
+        typedef T&			reference;
+        typedef const T&	const_reference;
+        typedef size_t		size_type;
+        typedef ptrdiff_t	difference_type;
+
+        enum{ alignment = Align < alignof(T) ? alignof(T) : Align };
+
+        template <class U>
+        struct rebind {
+            typedef aligned_allocator<U, Align> other;
+        };
+
+        static T* allocate();
+        static T* allocate(size_t n);
+        static void deallocate(T* ptr);
+        static void deallocate(T* ptr, size_t n);
+        static T* reallocate(T* ptr, size_t old_n, size_t new_n);
+        static size_t usable_size(size_t n);
+
+        template <class... Args>
+        static void construct(T *ptr, Args&&... args);
+        static void destroy(T *ptr);
+        static void destroy(T *first, T *last);
+
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type is_always_equal;
+
+        aligned_allocator()= default;
+        template <class U>
+        aligned_allocator(const aligned_allocator<U, Align>&) {}
+        ~aligned_allocator()= default;
+    };
+
+    template <class T, class U, size_t Align>
+    bool operator==(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&) { return true; }
+    template <class T, class U, size_t Align>
+    bool operator!=(const aligned_allocator<T, Align>&, const aligned_allocator<U, Align>&) { return false; }
+
+    template<class T, size_t Align>
+    T *aligned_allocator<T, Align>::allocate() {
+        return static_cast<T*>(alloc::allocate(sizeof(T), alignment));
+    }
+
+    template<class T, size_t Align>
+    T *aligned_allocator<T, Align>::allocate(size_t n) {
+        return static_cast<T*>(alloc::allocate(sizeof(T) * n, alignment));
+    }
+
+    template<class T, size_t Align>
+    void aligned_allocator<T, Align>::deallocate(T *ptr) {
+        alloc::deallocate(static_cast<void *>(ptr), sizeof(T), alignment);
+    }
+
+    template<class T, size_t Align>
+    void aligned_allocator<T, Align>::deallocate(T *ptr, size_t n) {
+        if (ptr == nullptr) return;
+        alloc::deallocate(static_cast<void *>(ptr), sizeof(T) * n, alignment);
+    }
+
+    template<class T, size_t Align>
+    T *aligned_allocator<T, Align>::reallocate(T *ptr, size_t old_n, size_t new_n) {
+        return static_cast<T*>(alloc::reallocate(static_cast<void *>(ptr), sizeof(T) * old_n, sizeof(T) * new_n, alignment));
+    }
+
+    template<class T, size_t Align>
+    size_t aligned_allocator<T, Align>::usable_size(size_t n) {
+        return alloc::usable_size(sizeof(T) * n, alignment) / sizeof(T);
+    }
+
+    template<class T, size_t Align>
+    template<class... Args>
+    void aligned_allocator<T, Align>::construct(T *ptr, Args&&... args) {
+        STL::construct(ptr, std::forward<Args>(args)...);
+    }
+
+    template<class T, size_t Align>
+    void aligned_allocator<T, Align>::destroy(T *ptr) {
+        STL::destroy(ptr);
+    }
+
+    template<class T, size_t Align>
+    void aligned_allocator<T, Align>::destroy(T *first, T *last) {
+        STL::destroy(first, last);
+    }
 }
 #endif //MY_TINY_STL_ALLOCATOR_H
@@ -0,0 +1,217 @@
+#ifndef MY_TINY_STL_ALLOCATOR_TRAITS_H
+#define MY_TINY_STL_ALLOCATOR_TRAITS_H
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "construct.h"
+
+namespace STL {
+    /*
+     * 容器通过allocator_traits使用配置器，而不是直接调用配置器的静态函数
+     * 这样配置器可以带状态(指向某个内存池、arena)，容器保存一份配置器实例
+     * 配置器缺少的成员由这里补上默认实现
+     */
+
+    //检测Alloc是否定义了名为X的成员类型，有则取之，否则取Default
+#define MY_TINY_STL_ALLOC_MEMBER_TYPE(X, Default)                                   \
+    template <class Alloc>                                                          \
+    struct __alloc_##X {                                                            \
+    private:                                                                        \
+        template <class A> static typename A::X test(int);                          \
+        template <class A> static Default test(...);                                \
+    public:                                                                         \
+        typedef decltype(test<Alloc>(0)) type;                                      \
+    };
+
+    MY_TINY_STL_ALLOC_MEMBER_TYPE(propagate_on_container_copy_assignment, std::false_type)
+    MY_TINY_STL_ALLOC_MEMBER_TYPE(propagate_on_container_move_assignment, std::false_type)
+    MY_TINY_STL_ALLOC_MEMBER_TYPE(propagate_on_container_swap, std::false_type)
+    MY_TINY_STL_ALLOC_MEMBER_TYPE(is_always_equal, typename std::is_empty<A>::type)
+    MY_TINY_STL_ALLOC_MEMBER_TYPE(trivial_deallocate, std::false_type)
+#undef MY_TINY_STL_ALLOC_MEMBER_TYPE
+
+    //rebind：优先使用Alloc::rebind<U>::other，否则把Alloc<T, Args...>的第一个模板参数换成U
+    template <class Alloc, class U>
+    struct __alloc_rebind_default;
+
+    template <template <class, class...> class A, class T, class... Args, class U>
+    struct __alloc_rebind_default<A<T, Args...>, U> {
+        typedef A<U, Args...> type;
+    };
+
+    template <class Alloc, class U>
+    struct __alloc_rebind {
+    private:
+        template <class A> static typename A::template rebind<U>::other test(int);
+        template <class A> static typename __alloc_rebind_default<A, U>::type test(...);
+    public:
+        typedef decltype(test<Alloc>(0)) type;
+    };
+
+    template <class Alloc>
+    struct allocator_traits {
+        typedef Alloc                               allocator_type;
+        typedef typename Alloc::value_type          value_type;
+        typedef value_type*                         pointer;
+        typedef const value_type*                   const_pointer;
+        typedef size_t                              size_type;
+        typedef ptrdiff_t                           difference_type;
+
+        typedef typename __alloc_propagate_on_container_copy_assignment<Alloc>::type
+                propagate_on_container_copy_assignment;
+        typedef typename __alloc_propagate_on_container_move_assignment<Alloc>::type
+                propagate_on_container_move_assignment;
+        typedef typename __alloc_propagate_on_container_swap<Alloc>::type
+                propagate_on_container_swap;
+        typedef typename __alloc_is_always_equal<Alloc>::type
+                is_always_equal;
+        //配置器声明deallocate什么也不做(如arena)，容器整体丢弃节点时可以不逐个归还
+        typedef typename __alloc_trivial_deallocate<Alloc>::type
+                trivial_deallocate;
+
+        /*
+         * 元素可平凡析构且deallocate什么也不做时，丢弃一批节点不需要任何逐节点的工作，
+         * 节点式容器的clear可以直接把结构置空而不遍历
+         */
+        template <class U>
+        using trivial_discard = std::integral_constant<bool,
+                trivial_deallocate::value && std::is_trivially_destructible<U>::value>;
+
+        template <class U>
+        using rebind_alloc = typename __alloc_rebind<Alloc, U>::type;
+        template <class U>
+        using rebind_traits = allocator_traits<rebind_alloc<U>>;
+
+        static pointer allocate(Alloc& a, size_type n) {
+            return a.allocate(n);
+        }
+        static void deallocate(Alloc& a, pointer p, size_type n) {
+            a.deallocate(p, n);
+        }
+        /*
+         * 把容纳old_n个元素的空间调整为new_n个，按字节搬运，只适用于可平凡复制的元素
+         * 配置器有reallocate时交给它(可能原地增长)，否则分配新空间再复制
+         */
+        static pointer reallocate(Alloc& a, pointer p, size_type old_n, size_type new_n) {
+            return __reallocate(a, p, old_n, new_n, 0);
+        }
+
+        //申请n个元素时配置器实际交付的容量，配置器没有usable_size时就是n
+        static size_type usable_size(const Alloc& a, size_type n) {
+            return __usable_size(a, n, 0);
+        }
+
+        //配置器有对应的construct/destroy就调用它，否则直接placement new/析构
+        template <class U, class... Args>
+        static void construct(Alloc& a, U* p, Args&&... args) {
+            __construct(0, a, p, std::forward<Args>(args)...);
+        }
+        template <class U>
+        static void destroy(Alloc& a, U* p) {
+            __destroy(a, p, 0);
+        }
+        //析构一段元素，可平凡析构的元素不做任何事
+        template <class U>
+        static void destroy(Alloc& a, U* first, U* last) {
+            __destroy_range(a, first, last, 0);
+        }
+
+        //复制构造容器时新容器使用的配置器
+        static Alloc select_on_container_copy_construction(const Alloc& a) {
+            return __select(a, 0);
+        }
+
+        //两个配置器分配的内存能否互相释放
+        static bool equal(const Alloc& a, const Alloc& b) {
+            return is_always_equal::value || a == b;
+        }
+
+    private:
+        template <class A>
+        static auto __reallocate(A& a, pointer p, size_type old_n, size_type new_n, int)
+                -> decltype(a.reallocate(p, old_n, new_n)) {
+            return a.reallocate(p, old_n, new_n);
+        }
+        template <class A>
+        static pointer __reallocate(A& a, pointer p, size_type old_n, size_type new_n, long) {
+            pointer result = a.allocate(new_n);
+            if (p != nullptr) {
+                memcpy(static_cast<void*>(result), static_cast<void*>(p),
+                       sizeof(value_type) * (old_n < new_n ? old_n : new_n));
+                a.deallocate(p, old_n);
+            }
+            return result;
+        }
+
+        template <class A>
+        static auto __usable_size(const A& a, size_type n, int) -> decltype(a.usable_size(n)) {
+            return a.usable_size(n);
+        }
+        template <class A>
+        static size_type __usable_size(const A&, size_type n, long) {
+            return n;
+        }
+
+        template <class A, class U, class... Args>
+        static auto __construct(int, A& a, U* p, Args&&... args)
+                -> decltype(a.construct(p, std::forward<Args>(args)...)) {
+            a.construct(p, std::forward<Args>(args)...);
+        }
+        template <class A, class U, class... Args>
+        static void __construct(long, A&, U* p, Args&&... args) {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        template <class A, class U>
+        static auto __destroy(A& a, U* p, int) -> decltype(a.destroy(p)) {
+            a.destroy(p);
+        }
+        template <class A, class U>
+        static void __destroy(A&, U* p, long) {
+            p->~U();
+        }
+
+        template <class A, class U>
+        static auto __destroy_range(A& a, U* first, U* last, int) -> decltype(a.destroy(first, last)) {
+            a.destroy(first, last);
+        }
+        template <class A, class U>
+        static void __destroy_range(A&, U* first, U* last, long) {
+            STL::destroy(first, last);
+        }
+
+        template <class A>
+        static auto __select(const A& a, int) -> decltype(a.select_on_container_copy_construction()) {
+            return a.select_on_container_copy_construction();
+        }
+        template <class A>
+        static Alloc __select(const A& a, long) {
+            return a;
+        }
+    };
+
+    /*
+     * 容器赋值、交换时按propagate_on_container_*决定是否连同配置器一起复制/移动/交换
+     */
+    template <class Alloc>
+    void __alloc_on_copy(Alloc& dst, const Alloc& src) {
+        if (allocator_traits<Alloc>::propagate_on_container_copy_assignment::value) dst = src;
+    }
+
+    template <class Alloc>
+    void __alloc_on_move(Alloc& dst, Alloc& src) {
+        if (allocator_traits<Alloc>::propagate_on_container_move_assignment::value) dst = std::move(src);
+    }
+
+    template <class Alloc>
+    void __alloc_on_swap(Alloc& a, Alloc& b) {
+        if (allocator_traits<Alloc>::propagate_on_container_swap::value) {
+            Alloc tmp = a;
+            a = b;
+            b = tmp;
+        }
+    }
+}
+#endif //MY_TINY_STL_ALLOCATOR_TRAITS_H
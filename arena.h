@@ -0,0 +1,257 @@
+#ifndef MY_TINY_STL_ARENA_H
+#define MY_TINY_STL_ARENA_H
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include "construct.h"
+
+namespace STL {
+    /*
+     * 单调增长的内存区：在大块内存上移动指针分配，deallocate什么也不做，
+     * release()一次性把所有块还给系统，适合“构建一批节点、用完整体丢弃”的场景
+     * 块大小按几何级数增长，单次请求超过当前块大小时单独申请一块恰好够用的
+     * 不是线程安全的，一个arena只应由一个线程使用
+     */
+    class monotonic_arena {
+    private:
+        enum{ __MIN_BLOCK = 4096 };
+        enum{ __MAX_BLOCK = 1 << 24 }; //几何增长的上限，16MB
+        //每个块头部记录前一个块和块大小，块之间串成单链表
+        struct block_header {
+            block_header* prev;
+            size_t size;
+        };
+        block_header* head; //最新的块
+        char* cur; //当前块中下一次分配的起点
+        char* end; //当前块终点
+        size_t initial_size;
+        size_t next_size; //下一个块的大小
+        size_t used_bytes; //已分配出去的字节数
+        size_t held_bytes; //向系统持有的字节数
+
+        //申请一个至少能放下bytes字节（按align对齐）的新块
+        void new_block(size_t bytes, size_t align);
+
+    public:
+        explicit monotonic_arena(size_t initial_block = 16 * __MIN_BLOCK);
+        ~monotonic_arena();
+        monotonic_arena(const monotonic_arena&) = delete;
+        monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+        void* allocate(size_t bytes, size_t align = alignof(std::max_align_t));
+        void deallocate(void*, size_t) {}
+        /*
+         * 把ptr处old_sz字节的区块调整为new_sz字节，保留原有内容
+         * ptr恰好是最后一次分配且当前块放得下时原地调整，否则重新分配再复制
+         */
+        void* reallocate(void* ptr, size_t old_sz, size_t new_sz, size_t align = alignof(std::max_align_t));
+        //把所有块还给系统，之前分配出去的内存全部失效
+        void release();
+        //同release，但保留最大的一块供下一轮使用，避免反复向系统申请
+        void reset();
+
+        size_t used() const { return used_bytes; }
+        size_t capacity() const { return held_bytes; }
+    };
+
+    inline monotonic_arena::monotonic_arena(size_t initial_block)
+            : head(nullptr), cur(nullptr), end(nullptr),
+              initial_size(initial_block < size_t(__MIN_BLOCK) ? size_t(__MIN_BLOCK) : initial_block),
+              next_size(initial_size), used_bytes(0), held_bytes(0) {}
+
+    inline monotonic_arena::~monotonic_arena() {
+        release();
+    }
+
+    inline void monotonic_arena::new_block(size_t bytes, size_t align) {
+        size_t need = sizeof(block_header) + bytes + align;
+        size_t size = next_size < need ? need : next_size;
+        block_header* block = static_cast<block_header*>(malloc(size));
+        if (block == nullptr) throw std::bad_alloc();
+        block->prev = head;
+        block->size = size;
+        head = block;
+        cur = reinterpret_cast<char*>(block + 1);
+        end = reinterpret_cast<char*>(block) + size;
+        held_bytes += size;
+        if (next_size < __MAX_BLOCK) next_size *= 2;
+    }
+
+    inline void* monotonic_arena::allocate(size_t bytes, size_t align) {
+        size_t pad = (align - reinterpret_cast<size_t>(cur) % align) % align;
+        if (cur == nullptr || static_cast<size_t>(end - cur) < pad + bytes) {
+            new_block(bytes, align);
+            pad = (align - reinterpret_cast<size_t>(cur) % align) % align;
+        }
+        char* result = cur + pad;
+        cur = result + bytes;
+        used_bytes += bytes;
+        return result;
+    }
+
+    inline void* monotonic_arena::reallocate(void* ptr, size_t old_sz, size_t new_sz, size_t align) {
+        char* p = static_cast<char*>(ptr);
+        if (p != nullptr && p + old_sz == cur && static_cast<size_t>(end - p) >= new_sz) {
+            cur = p + new_sz;
+            used_bytes = used_bytes - old_sz + new_sz;
+            return ptr;
+        }
+        if (new_sz <= old_sz) return ptr;
+        void* result = allocate(new_sz, align);
+        if (p != nullptr) memcpy(result, p, old_sz);
+        return result;
+    }
+
+    inline void monotonic_arena::release() {
+        while (head != nullptr) {
+            block_header* prev = head->prev;
+            free(head);
+            head = prev;
+        }
+        cur = end = nullptr;
+        next_size = initial_size;
+        used_bytes = held_bytes = 0;
+    }
+
+    inline void monotonic_arena::reset() {
+        block_header* keep = nullptr;
+        while (head != nullptr) {
+            block_header* prev = head->prev;
+            if (keep == nullptr || head->size > keep->size) {
+                if (keep != nullptr) free(keep);
+                keep = head;
+            }
+            else free(head);
+            head = prev;
+        }
+        used_bytes = 0;
+        held_bytes = 0;
+        if (keep != nullptr) {
+            keep->prev = nullptr;
+            head = keep;
+            cur = reinterpret_cast<char*>(keep + 1);
+            end = reinterpret_cast<char*>(keep) + keep->size;
+            held_bytes = keep->size;
+        }
+        else cur = end = nullptr;
+    }
+
+    /*
+     * 当前线程正在使用的arena，由arena_scope设置，未设置时使用本线程默认的arena
+     * 默认arena直到线程退出才释放
+     */
+    inline monotonic_arena*& __current_arena_slot() {
+        static thread_local monotonic_arena* current = nullptr;
+        return current;
+    }
+
+    inline monotonic_arena& current_arena() {
+        static thread_local monotonic_arena default_arena;
+        monotonic_arena* current = __current_arena_slot();
+        return current != nullptr ? *current : default_arena;
+    }
+
+    //在作用域内把arena设为当前线程的arena，离开时恢复之前的设置，可嵌套
+    class arena_scope {
+    private:
+        monotonic_arena* prev;
+    public:
+        explicit arena_scope(monotonic_arena& arena) : prev(__current_arena_slot()) {
+            __current_arena_slot() = &arena;
+        }
+        ~arena_scope() {
+            __current_arena_slot() = prev;
+        }
+        arena_scope(const arena_scope&) = delete;
+        arena_scope& operator=(const arena_scope&) = delete;
+    };
+
+    /*
+     * 从monotonic_arena分配的配置器，deallocate不做任何事，可作为任何容器的Alloc参数
+     * 每个实例记住自己的arena，默认构造时取current_arena()，也可以显式指定，
+     * 于是不同容器可以各自使用不同的arena；容器必须在它用到的arena release之前析构
+     * 复制赋值时容器保留自己的arena，移动赋值和交换时arena随内容一起转移
+     */
+    template <class T>
+    class arena_allocator {
+    public:
+        typedef T			value_type;
+        typedef T*			pointer;
+        typedef const T*	const_pointer;
+        typedef T&			reference;
+        typedef const T&	const_reference;
+        typedef size_t		size_type;
+        typedef ptrdiff_t	difference_type;
+
+        template <class U>
+        struct rebind {
+            typedef arena_allocator<U> other;
+        };
+
+        typedef std::false_type propagate_on_container_copy_assignment;
+        typedef std::true_type  propagate_on_container_move_assignment;
+        typedef std::true_type  propagate_on_container_swap;
+        typedef std::false_type is_always_equal;
+        typedef std::true_type  trivial_deallocate; //内存随arena一起释放
+
+        arena_allocator() : arena(&current_arena()) {}
+        explicit arena_allocator(monotonic_arena& a) : arena(&a) {}
+        template <class U>
+        arena_allocator(const arena_allocator<U>& rhs) : arena(rhs.resource()) {}
+
+        T* allocate();
+        T* allocate(size_t n);
+        void deallocate(T*) {}
+        void deallocate(T*, size_t) {}
+        T* reallocate(T* ptr, size_t old_n, size_t new_n);
+
+        template <class... Args>
+        void construct(T *ptr, Args&&... args);
+        void destroy(T *ptr);
+        void destroy(T *first, T *last);
+
+        monotonic_arena* resource() const { return arena; }
+
+    private:
+        monotonic_arena* arena;
+    };
+
+    template<class T>
+    T *arena_allocator<T>::allocate() {
+        return static_cast<T*>(arena->allocate(sizeof(T), alignof(T)));
+    }
+
+    template<class T>
+    T *arena_allocator<T>::allocate(size_t n) {
+        return static_cast<T*>(arena->allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    template<class T>
+    T *arena_allocator<T>::reallocate(T *ptr, size_t old_n, size_t new_n) {
+        return static_cast<T*>(arena->reallocate(ptr, sizeof(T) * old_n, sizeof(T) * new_n, alignof(T)));
+    }
+
+    template<class T>
+    template<class... Args>
+    void arena_allocator<T>::construct(T *ptr, Args&&... args) {
+        STL::construct(ptr, std::forward<Args>(args)...);
+    }
+
+    template<class T>
+    void arena_allocator<T>::destroy(T *ptr) {
+        STL::destroy(ptr);
+    }
+
+    template<class T>
+    void arena_allocator<T>::destroy(T *first, T *last) {
+        STL::destroy(first, last);
+    }
+
+    template <class T, class U>
+    bool operator==(const arena_allocator<T>& a, const arena_allocator<U>& b) { return a.resource() == b.resource(); }
+    template <class T, class U>
+    bool operator!=(const arena_allocator<T>& a, const arena_allocator<U>& b) { return a.resource() != b.resource(); }
+}
+#endif //MY_TINY_STL_ARENA_H
@@ -0,0 +1,433 @@
+#ifndef MY_TINY_STL_CIRCULAR_BUFFER_H
+#define MY_TINY_STL_CIRCULAR_BUFFER_H
+#include "allocator.h"
+#include "iterator.h"
+#include "uninitialized.h"
+#include "algorithm.h"
+#include <type_traits>
+namespace STL {
+    /*
+     * 环形缓冲区：容量取2的幂，下标用按位与回绕，头尾插入删除都是O(1)，不像deque那样管理map
+     * 满了之后的行为由overflow_policy决定：grow扩容为两倍，overwrite覆盖另一端最旧的元素(滑动窗口)，
+     * reject拒绝插入；push系列函数返回元素是否放入
+     * 有push_back/pop_front/front/back等接口，可以作为queue和stack的Sequence
+     * push_n(n)/pop_n(n)/peek_n(n)一次处理n个元素，返回最多两段连续内存，便于直接交给read/write/writev，
+     * 这几个只适用于可平凡复制的T
+     */
+    template <class T, class Alloc = allocator<T>>
+    class circular_buffer {
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef T&          reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<T> allocator_type;
+
+        enum overflow_policy { grow, overwrite, reject };
+
+        //环形区间展开后的两段连续内存，second_len为0时只有一段
+        struct span_pair {
+            T* first;
+            size_type first_len;
+            T* second;
+            size_type second_len;
+
+            size_type size() const { return first_len + second_len; }
+        };
+
+        //按逻辑下标遍历的随机访问迭代器
+        struct iterator : public STL::iterator<random_access_iterator_tag, T> {
+            circular_buffer* b;
+            size_type i;
+
+            iterator(circular_buffer* buf = nullptr, size_type idx = 0) : b(buf), i(idx) {}
+            reference operator*() const { return (*b)[i]; }
+            pointer operator->() const { return &(*b)[i]; }
+            reference operator[](difference_type n) const { return (*b)[i + n]; }
+            iterator& operator++() { ++ i; return *this; }
+            iterator operator++(int) { iterator tmp = *this; ++ i; return tmp; }
+            iterator& operator--() { -- i; return *this; }
+            iterator operator--(int) { iterator tmp = *this; -- i; return tmp; }
+            iterator& operator+=(difference_type n) { i += n; return *this; }
+            iterator& operator-=(difference_type n) { i -= n; return *this; }
+            iterator operator+(difference_type n) const { return iterator(b, i + n); }
+            iterator operator-(difference_type n) const { return iterator(b, i - n); }
+            difference_type operator-(const iterator& x) const { return difference_type(i) - difference_type(x.i); }
+            bool operator==(const iterator& x) const { return i == x.i; }
+            bool operator!=(const iterator& x) const { return i != x.i; }
+            bool operator<(const iterator& x) const { return i < x.i; }
+        };
+
+    private:
+        typedef allocator_type data_allocator;
+        typedef allocator_traits<data_allocator> alloc_traits;
+        T* buf;
+        size_type cap; //0或2的幂
+        size_type head; //第一个元素的槽位
+        size_type len;
+        overflow_policy pol;
+        data_allocator data_alloc; //容器持有的配置器实例
+
+        size_type mask() const { return cap - 1; }
+        T* slot(size_type i) const { return buf + ((head + i) & mask()); }
+        static size_type round_up(size_type n);
+        //逻辑区间[pos, pos + n)对应的两段内存
+        span_pair spans(size_type pos, size_type n) const;
+        //按顺序把元素搬到容量为new_cap的新空间的offset处
+        void relocate_to(T* new_buf, size_type offset);
+        void grow_to(size_type new_cap);
+        //满了并且policy为grow时：在新空间的pos处用args构造新元素，再搬旧元素，args引用本容器的元素也安全
+        template <class... Args>
+        void realloc_emplace(size_type pos, Args&&... args);
+        //复制n个元素到dst，返回源的下一个位置；能随机访问时交给copy，指针区间会变成memmove
+        template <class InputIterator>
+        static InputIterator copy_in(InputIterator first, size_type n, T* dst, random_access_iterator_tag) {
+            STL::copy(first, first + n, dst);
+            return first + n;
+        }
+        template <class InputIterator>
+        static InputIterator copy_in(InputIterator first, size_type n, T* dst, input_iterator_tag) {
+            for (; n > 0; -- n, ++ first, ++ dst) *dst = *first;
+            return first;
+        }
+        template <class InputIterator>
+        size_type push_n_aux(InputIterator first, size_type n, std::true_type);
+        template <class InputIterator>
+        size_type push_n_aux(InputIterator first, size_type n, std::false_type);
+        template <class OutputIterator>
+        size_type pop_n_aux(OutputIterator out, size_type n, std::true_type);
+        template <class OutputIterator>
+        size_type pop_n_aux(OutputIterator out, size_type n, std::false_type);
+
+    public:
+        //构造函数，复制构造函数，析构函数；capacity向上取到2的幂
+        explicit circular_buffer(size_type capacity = 0, overflow_policy p = grow,
+                                 const allocator_type& a = allocator_type());
+        circular_buffer(const circular_buffer& c);
+        circular_buffer(circular_buffer&& c) noexcept;
+        ~circular_buffer();
+        circular_buffer& operator=(const circular_buffer& c);
+        circular_buffer& operator=(circular_buffer&& c) noexcept;
+        void swap(circular_buffer& c) noexcept;
+
+        allocator_type get_allocator() const { return data_alloc; }
+        overflow_policy policy() const { return pol; }
+        void set_policy(overflow_policy p) { pol = p; }
+
+        //迭代器相关
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, len); }
+
+        //容量相关
+        size_type size() const { return len; }
+        size_type capacity() const { return cap; }
+        bool empty() const { return len == 0; }
+        bool full() const { return len == cap; }
+        void reserve(size_type n);
+
+        //元素访问
+        reference front() { return *slot(0); }
+        reference back() { return *slot(len - 1); }
+        reference operator[](size_type n) { return *slot(n); }
+        const T& operator[](size_type n) const { return *slot(n); }
+
+        //元素调整
+        bool push_back(const value_type& val) { return emplace_back(val); }
+        bool push_back(value_type&& val) { return emplace_back(std::move(val)); }
+        template <class... Args>
+        bool emplace_back(Args&&... args);
+        bool push_front(const value_type& val) { return emplace_front(val); }
+        bool push_front(value_type&& val) { return emplace_front(std::move(val)); }
+        template <class... Args>
+        bool emplace_front(Args&&... args);
+        void pop_front();
+        void pop_back();
+        void clear();
+
+        //批量操作
+        //在尾部追加n个未初始化的槽位(reject时不超过剩余空间，overwrite时丢弃最旧的元素腾出空间)，返回它们所在的内存，由调用者写入
+        span_pair push_n(size_type n);
+        //从头部取出n个元素(不超过size())，返回它们所在的内存，下一次push之前有效
+        span_pair pop_n(size_type n);
+        //头部n个元素所在的内存，不取出
+        span_pair peek_n(size_type n) const { return spans(0, n < len ? n : len); }
+        //复制[first, first + n)到尾部，返回放入的个数
+        template <class InputIterator>
+        size_type push_n(InputIterator first, size_type n);
+        //把头部最多n个元素移动到out，返回取出的个数
+        template <class OutputIterator>
+        size_type pop_n(OutputIterator out, size_type n);
+    };
+
+    //构造，析构，赋值
+    template<class T, class Alloc>
+    typename circular_buffer<T, Alloc>::size_type circular_buffer<T, Alloc>::round_up(size_type n) {
+        size_type c = 1;
+        while (c < n) c <<= 1;
+        return c;
+    }
+
+    template<class T, class Alloc>
+    circular_buffer<T, Alloc>::circular_buffer(size_type capacity, overflow_policy p, const allocator_type& a)
+            : buf(nullptr), cap(0), head(0), len(0), pol(p), data_alloc(a) {
+        if (capacity != 0) {
+            cap = round_up(capacity);
+            buf = alloc_traits::allocate(data_alloc, cap);
+        }
+    }
+
+    template<class T, class Alloc>
+    circular_buffer<T, Alloc>::circular_buffer(const circular_buffer& c)
+            : buf(nullptr), cap(c.cap), head(0), len(0), pol(c.pol),
+              data_alloc(alloc_traits::select_on_container_copy_construction(c.data_alloc)) {
+        if (cap != 0) buf = alloc_traits::allocate(data_alloc, cap);
+        for (; len < c.len; ++ len) STL::construct(buf + len, c[len]);
+    }
+
+    template<class T, class Alloc>
+    circular_buffer<T, Alloc>::circular_buffer(circular_buffer&& c) noexcept
+            : buf(c.buf), cap(c.cap), head(c.head), len(c.len), pol(c.pol), data_alloc(std::move(c.data_alloc)) {
+        c.buf = nullptr;
+        c.cap = c.head = c.len = 0;
+    }
+
+    template<class T, class Alloc>
+    circular_buffer<T, Alloc>::~circular_buffer() {
+        clear();
+        if (buf) alloc_traits::deallocate(data_alloc, buf, cap);
+    }
+
+    template<class T, class Alloc>
+    circular_buffer<T, Alloc>& circular_buffer<T, Alloc>::operator=(const circular_buffer& c) {
+        if (this != &c) {
+            circular_buffer tmp(c);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    template<class T, class Alloc>
+    circular_buffer<T, Alloc>& circular_buffer<T, Alloc>::operator=(circular_buffer&& c) noexcept {
+        if (this != &c) swap(c);
+        return *this;
+    }
+
+    template<class T, class Alloc>
+    void circular_buffer<T, Alloc>::swap(circular_buffer& c) noexcept {
+        STL::swap(buf, c.buf);
+        STL::swap(cap, c.cap);
+        STL::swap(head, c.head);
+        STL::swap(len, c.len);
+        STL::swap(pol, c.pol);
+        STL::swap(data_alloc, c.data_alloc);
+    }
+
+    //容量相关
+    template<class T, class Alloc>
+    typename circular_buffer<T, Alloc>::span_pair circular_buffer<T, Alloc>::spans(size_type pos, size_type n) const {
+        span_pair s = {nullptr, 0, nullptr, 0};
+        if (n == 0) return s;
+        const size_type begin = (head + pos) & mask();
+        s.first = buf + begin;
+        s.first_len = n < cap - begin ? n : cap - begin;
+        s.second = buf;
+        s.second_len = n - s.first_len;
+        return s;
+    }
+
+    template<class T, class Alloc>
+    void circular_buffer<T, Alloc>::relocate_to(T* new_buf, size_type offset) {
+        span_pair s = spans(0, len);
+        if (s.first_len != 0) STL::uninitialized_relocate(s.first, s.first + s.first_len, new_buf + offset);
+        if (s.second_len != 0) STL::uninitialized_relocate(s.second, s.second + s.second_len, new_buf + offset + s.first_len);
+    }
+
+    template<class T, class Alloc>
+    void circular_buffer<T, Alloc>::grow_to(size_type new_cap) {
+        T* new_buf = alloc_traits::allocate(data_alloc, new_cap);
+        relocate_to(new_buf, 0);
+        if (buf) alloc_traits::deallocate(data_alloc, buf, cap);
+        buf = new_buf;
+        cap = new_cap;
+        head = 0;
+    }
+
+    template<class T, class Alloc>
+    void circular_buffer<T, Alloc>::reserve(size_type n) {
+        if (n > cap) grow_to(round_up(n));
+    }
+
+    //元素调整
+    template<class T, class Alloc>
+    template<class... Args>
+    void circular_buffer<T, Alloc>::realloc_emplace(size_type pos, Args&&... args) {
+        const size_type new_cap = cap == 0 ? 1 : cap * 2;
+        T* new_buf = alloc_traits::allocate(data_alloc, new_cap);
+        try {
+            alloc_traits::construct(data_alloc, new_buf + pos, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            alloc_traits::deallocate(data_alloc, new_buf, new_cap);
+            throw;
+        }
+        relocate_to(new_buf, pos == 0 ? 1 : 0);
+        if (buf) alloc_traits::deallocate(data_alloc, buf, cap);
+        buf = new_buf;
+        cap = new_cap;
+        head = 0;
+        ++ len;
+    }
+
+    template<class T, class Alloc>
+    template<class... Args>
+    bool circular_buffer<T, Alloc>::emplace_back(Args&&... args) {
+        if (len != cap) {
+            alloc_traits::construct(data_alloc, slot(len), std::forward<Args>(args)...);
+            ++ len;
+            return true;
+        }
+        if (pol == grow) {
+            realloc_emplace(len, std::forward<Args>(args)...);
+            return true;
+        }
+        if (pol == reject || cap == 0) return false;
+        //满了时尾后的槽位就是最旧的元素，先构造好再赋值过去，args可能引用它
+        T x(std::forward<Args>(args)...);
+        *slot(0) = std::move(x);
+        head = (head + 1) & mask();
+        return true;
+    }
+
+    template<class T, class Alloc>
+    template<class... Args>
+    bool circular_buffer<T, Alloc>::emplace_front(Args&&... args) {
+        if (len != cap) {
+            alloc_traits::construct(data_alloc, slot(cap - 1), std::forward<Args>(args)...);
+            head = (head - 1) & mask();
+            ++ len;
+            return true;
+        }
+        if (pol == grow) {
+            realloc_emplace(0, std::forward<Args>(args)...);
+            return true;
+        }
+        if (pol == reject || cap == 0) return false;
+        //满了时头前的槽位就是最后一个元素
+        T x(std::forward<Args>(args)...);
+        *slot(len - 1) = std::move(x);
+        head = (head - 1) & mask();
+        return true;
+    }
+
+    template<class T, class Alloc>
+    void circular_buffer<T, Alloc>::pop_front() {
+        alloc_traits::destroy(data_alloc, slot(0));
+        head = (head + 1) & mask();
+        -- len;
+    }
+
+    template<class T, class Alloc>
+    void circular_buffer<T, Alloc>::pop_back() {
+        alloc_traits::destroy(data_alloc, slot(len - 1));
+        -- len;
+    }
+
+    template<class T, class Alloc>
+    void circular_buffer<T, Alloc>::clear() {
+        span_pair s = spans(0, len);
+        alloc_traits::destroy(data_alloc, s.first, s.first + s.first_len);
+        alloc_traits::destroy(data_alloc, s.second, s.second + s.second_len);
+        head = len = 0;
+    }
+
+    //批量操作
+    template<class T, class Alloc>
+    typename circular_buffer<T, Alloc>::span_pair circular_buffer<T, Alloc>::push_n(size_type n) {
+        static_assert(std::is_trivially_copyable<T>::value, "push_n(n) requires a trivially copyable T");
+        if (len + n > cap) {
+            if (pol == grow) reserve(len + n);
+            else if (pol == reject) n = cap - len;
+            else { //丢弃最旧的元素
+                if (n > cap) n = cap;
+                const size_type drop = len + n - cap;
+                head = (head + drop) & mask();
+                len -= drop;
+            }
+        }
+        span_pair s = spans(len, n);
+        len += n;
+        return s;
+    }
+
+    template<class T, class Alloc>
+    typename circular_buffer<T, Alloc>::span_pair circular_buffer<T, Alloc>::pop_n(size_type n) {
+        static_assert(std::is_trivially_copyable<T>::value, "pop_n(n) requires a trivially copyable T");
+        if (n > len) n = len;
+        span_pair s = spans(0, n);
+        head = (head + n) & mask();
+        len -= n;
+        return s;
+    }
+
+    //可平凡复制的元素先占好槽位，再逐段复制
+    template<class T, class Alloc>
+    template<class InputIterator>
+    typename circular_buffer<T, Alloc>::size_type
+    circular_buffer<T, Alloc>::push_n_aux(InputIterator first, size_type n, std::true_type) {
+        if (pol == overwrite && n > cap) { //前面的会被后面的覆盖掉，只需要最后cap个
+            STL::advance(first, n - cap);
+            n = cap;
+        }
+        span_pair s = push_n(n);
+        typedef typename iterator_traits<InputIterator>::iterator_category category;
+        first = copy_in(first, s.first_len, s.first, category());
+        copy_in(first, s.second_len, s.second, category());
+        return s.size();
+    }
+
+    template<class T, class Alloc>
+    template<class InputIterator>
+    typename circular_buffer<T, Alloc>::size_type
+    circular_buffer<T, Alloc>::push_n_aux(InputIterator first, size_type n, std::false_type) {
+        size_type pushed = 0;
+        for (; pushed < n && emplace_back(*first); ++ pushed, ++ first) {}
+        return pushed;
+    }
+
+    template<class T, class Alloc>
+    template<class InputIterator>
+    typename circular_buffer<T, Alloc>::size_type circular_buffer<T, Alloc>::push_n(InputIterator first, size_type n) {
+        return push_n_aux(first, n, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+    }
+
+    template<class T, class Alloc>
+    template<class OutputIterator>
+    typename circular_buffer<T, Alloc>::size_type
+    circular_buffer<T, Alloc>::pop_n_aux(OutputIterator out, size_type n, std::true_type) {
+        span_pair s = pop_n(n);
+        out = STL::copy(s.first, s.first + s.first_len, out);
+        STL::copy(s.second, s.second + s.second_len, out);
+        return s.size();
+    }
+
+    template<class T, class Alloc>
+    template<class OutputIterator>
+    typename circular_buffer<T, Alloc>::size_type
+    circular_buffer<T, Alloc>::pop_n_aux(OutputIterator out, size_type n, std::false_type) {
+        if (n > len) n = len;
+        for (size_type i = 0; i < n; ++ i, ++ out) {
+            *out = std::move(front());
+            pop_front();
+        }
+        return n;
+    }
+
+    template<class T, class Alloc>
+    template<class OutputIterator>
+    typename circular_buffer<T, Alloc>::size_type circular_buffer<T, Alloc>::pop_n(OutputIterator out, size_type n) {
+        return pop_n_aux(out, n, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+    }
+}
+
+#endif //MY_TINY_STL_CIRCULAR_BUFFER_H
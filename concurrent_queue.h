@@ -0,0 +1,312 @@
+#ifndef MY_TINY_STL_CONCURRENT_QUEUE_H
+#define MY_TINY_STL_CONCURRENT_QUEUE_H
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include "allocator.h"
+#include "allocator_traits.h"
+
+namespace STL {
+    /*
+     * 有界无锁队列，容量在构造时固定(向上取到2的幂)，槽位由配置器一次分配，push/pop不再分配内存
+     * try_*满或空时立即返回false，不阻塞；try_push_n/try_pop_n一次处理多个元素，返回实际处理的个数
+     * 两个下标分别放在不同的缓存行上，生产者和消费者不会因为伪共享互相拖慢；放在堆上时要用STL::allocator等按alignof分配
+     */
+
+    /*
+     * 单生产者单消费者队列：只有一个线程push、一个线程pop，两边都是wait-free的
+     * head只由消费者写，tail只由生产者写；各自缓存一份对方的下标，只有看起来满/空时才去读对方的缓存行
+     */
+    template <class T, class Alloc = allocator<T>>
+    class spsc_queue {
+    public:
+        typedef T           value_type;
+        typedef size_t      size_type;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<T> allocator_type;
+
+    private:
+        typedef allocator_traits<allocator_type> alloc_traits;
+        T* slots;
+        size_type mask;
+        allocator_type data_alloc;
+        alignas(64) std::atomic<size_type> head; //下一个要pop的位置
+        size_type tail_cache; //消费者看到的tail
+        alignas(64) std::atomic<size_type> tail; //下一个要push的位置
+        size_type head_cache; //生产者看到的head
+
+        size_type free_slots(size_type t);
+        size_type ready_slots(size_type h);
+
+    public:
+        explicit spsc_queue(size_type capacity, const allocator_type& a = allocator_type());
+        spsc_queue(const spsc_queue&) = delete;
+        spsc_queue& operator=(const spsc_queue&) = delete;
+        ~spsc_queue();
+
+        //以下只能由生产者调用
+        template <class... Args>
+        bool try_emplace(Args&&... args);
+        bool try_push(const value_type& val) { return try_emplace(val); }
+        bool try_push(value_type&& val) { return try_emplace(std::move(val)); }
+        //复制[first, first + n)中能放下的部分，只发布一次tail
+        template <class InputIterator>
+        size_type try_push_n(InputIterator first, size_type n);
+
+        //以下只能由消费者调用
+        bool try_pop(value_type& out);
+        //最多取n个移动到out，只发布一次head
+        template <class OutputIterator>
+        size_type try_pop_n(OutputIterator out, size_type n);
+
+        size_type capacity() const { return mask + 1; }
+        //其他线程调用时只是一个近似值
+        //先读head再读tail，tail不会落后于先读到的head；两次读之间可能又push了一轮，所以再截到容量
+        size_type size() const {
+            size_type h = head.load(std::memory_order_acquire);
+            size_type n = tail.load(std::memory_order_acquire) - h;
+            return n < capacity() ? n : capacity();
+        }
+        bool empty() const { return size() == 0; }
+    };
+
+    template<class T, class Alloc>
+    spsc_queue<T, Alloc>::spsc_queue(size_type capacity, const allocator_type& a)
+            : data_alloc(a), head(0), tail_cache(0), tail(0), head_cache(0) {
+        size_type cap = 1;
+        while (cap < capacity) cap <<= 1;
+        mask = cap - 1;
+        slots = alloc_traits::allocate(data_alloc, cap);
+    }
+
+    template<class T, class Alloc>
+    spsc_queue<T, Alloc>::~spsc_queue() {
+        size_type h = head.load(std::memory_order_relaxed), t = tail.load(std::memory_order_relaxed);
+        for (; h != t; ++ h) alloc_traits::destroy(data_alloc, slots + (h & mask));
+        alloc_traits::deallocate(data_alloc, slots, mask + 1);
+    }
+
+    template<class T, class Alloc>
+    typename spsc_queue<T, Alloc>::size_type spsc_queue<T, Alloc>::free_slots(size_type t) {
+        size_type free = mask + 1 - (t - head_cache);
+        if (free == 0) { //缓存的head可能过时了，重新读一次
+            head_cache = head.load(std::memory_order_acquire);
+            free = mask + 1 - (t - head_cache);
+        }
+        return free;
+    }
+
+    template<class T, class Alloc>
+    typename spsc_queue<T, Alloc>::size_type spsc_queue<T, Alloc>::ready_slots(size_type h) {
+        size_type ready = tail_cache - h;
+        if (ready == 0) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            ready = tail_cache - h;
+        }
+        return ready;
+    }
+
+    template<class T, class Alloc>
+    template<class... Args>
+    bool spsc_queue<T, Alloc>::try_emplace(Args&&... args) {
+        const size_type t = tail.load(std::memory_order_relaxed);
+        if (free_slots(t) == 0) return false;
+        alloc_traits::construct(data_alloc, slots + (t & mask), std::forward<Args>(args)...);
+        //release：消费者看到新的tail时元素已经构造好
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<class T, class Alloc>
+    template<class InputIterator>
+    typename spsc_queue<T, Alloc>::size_type spsc_queue<T, Alloc>::try_push_n(InputIterator first, size_type n) {
+        const size_type t = tail.load(std::memory_order_relaxed);
+        const size_type free = free_slots(t);
+        if (n > free) n = free;
+        for (size_type i = 0; i < n; ++ i, ++ first)
+            alloc_traits::construct(data_alloc, slots + ((t + i) & mask), *first);
+        if (n != 0) tail.store(t + n, std::memory_order_release);
+        return n;
+    }
+
+    template<class T, class Alloc>
+    bool spsc_queue<T, Alloc>::try_pop(value_type &out) {
+        const size_type h = head.load(std::memory_order_relaxed);
+        if (ready_slots(h) == 0) return false;
+        T* p = slots + (h & mask);
+        out = std::move(*p);
+        alloc_traits::destroy(data_alloc, p);
+        //release：生产者看到新的head时这个槽位已经析构完，可以重用
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<class T, class Alloc>
+    template<class OutputIterator>
+    typename spsc_queue<T, Alloc>::size_type spsc_queue<T, Alloc>::try_pop_n(OutputIterator out, size_type n) {
+        const size_type h = head.load(std::memory_order_relaxed);
+        const size_type ready = ready_slots(h);
+        if (n > ready) n = ready;
+        for (size_type i = 0; i < n; ++ i, ++ out) {
+            T* p = slots + ((h + i) & mask);
+            *out = std::move(*p);
+            alloc_traits::destroy(data_alloc, p);
+        }
+        if (n != 0) head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    /*
+     * 多生产者多消费者队列(Vyukov的有界队列)：每个槽位带一个序号，
+     * 序号等于pos时槽位空闲、等于pos + 1时已写入，生产者和消费者各用一次CAS推进自己的下标来认领槽位
+     * 批量操作先确认连续k个槽位都已就绪，再一次CAS认领全部k个：就绪的槽位在被认领之前不会变回未就绪，
+     * 所以检查和认领之间不需要加锁
+     */
+    template <class T, class Alloc = allocator<T>>
+    class mpmc_queue {
+    public:
+        typedef T           value_type;
+        typedef size_t      size_type;
+        typedef Alloc       allocator_type;
+
+    private:
+        struct cell {
+            std::atomic<size_type> seq;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+            T* value() { return reinterpret_cast<T*>(&storage); }
+        };
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<cell> cell_allocator;
+        typedef allocator_traits<cell_allocator> cell_traits;
+
+        cell* cells;
+        size_type mask;
+        cell_allocator cell_alloc;
+        alignas(64) std::atomic<size_type> enqueue_pos;
+        alignas(64) std::atomic<size_type> dequeue_pos;
+
+        //从pos开始数，最多n个连续的、序号为pos + i + offset的槽位个数
+        size_type ready_run(size_type pos, size_type n, size_type offset);
+        //认领[pos, pos + k)，k为0时表示满(或空)
+        size_type claim(std::atomic<size_type>& index, size_type n, size_type offset, size_type& pos);
+
+    public:
+        explicit mpmc_queue(size_type capacity, const allocator_type& a = allocator_type());
+        mpmc_queue(const mpmc_queue&) = delete;
+        mpmc_queue& operator=(const mpmc_queue&) = delete;
+        ~mpmc_queue();
+
+        template <class... Args>
+        bool try_emplace(Args&&... args);
+        bool try_push(const value_type& val) { return try_emplace(val); }
+        bool try_push(value_type&& val) { return try_emplace(std::move(val)); }
+        bool try_pop(value_type& out);
+        //一次CAS认领最多n个槽位
+        template <class InputIterator>
+        size_type try_push_n(InputIterator first, size_type n);
+        template <class OutputIterator>
+        size_type try_pop_n(OutputIterator out, size_type n);
+
+        size_type capacity() const { return mask + 1; }
+        //只是一个近似值
+        size_type size() const {
+            size_type e = enqueue_pos.load(std::memory_order_relaxed), d = dequeue_pos.load(std::memory_order_relaxed);
+            return e > d ? e - d : 0;
+        }
+        bool empty() const { return size() == 0; }
+    };
+
+    template<class T, class Alloc>
+    mpmc_queue<T, Alloc>::mpmc_queue(size_type capacity, const allocator_type& a)
+            : cell_alloc(a), enqueue_pos(0), dequeue_pos(0) {
+        size_type cap = 2; //容量为1时序号pos + 1与下一轮的pos相同，无法区分
+        while (cap < capacity) cap <<= 1;
+        mask = cap - 1;
+        cells = cell_traits::allocate(cell_alloc, cap);
+        for (size_type i = 0; i < cap; ++ i) ::new (&cells[i].seq) std::atomic<size_type>(i);
+    }
+
+    template<class T, class Alloc>
+    mpmc_queue<T, Alloc>::~mpmc_queue() {
+        size_type d = dequeue_pos.load(std::memory_order_relaxed), e = enqueue_pos.load(std::memory_order_relaxed);
+        for (; d != e; ++ d) STL::destroy(cells[d & mask].value());
+        cell_traits::deallocate(cell_alloc, cells, mask + 1);
+    }
+
+    template<class T, class Alloc>
+    typename mpmc_queue<T, Alloc>::size_type mpmc_queue<T, Alloc>::ready_run(size_type pos, size_type n, size_type offset) {
+        size_type k = 0;
+        while (k < n && cells[(pos + k) & mask].seq.load(std::memory_order_acquire) == pos + k + offset) ++ k;
+        return k;
+    }
+
+    template<class T, class Alloc>
+    typename mpmc_queue<T, Alloc>::size_type
+    mpmc_queue<T, Alloc>::claim(std::atomic<size_type>& index, size_type n, size_type offset, size_type& pos) {
+        pos = index.load(std::memory_order_relaxed);
+        for (;;) {
+            size_type seq = cells[pos & mask].seq.load(std::memory_order_acquire);
+            ptrdiff_t dif = ptrdiff_t(seq) - ptrdiff_t(pos + offset);
+            if (dif == 0) {
+                size_type k = n == 1 ? 1 : ready_run(pos, n, offset);
+                if (index.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) return k;
+                //失败时pos已更新为最新的下标
+            }
+            else if (dif < 0) return 0; //槽位还没被另一方处理完：满(或空)
+            else pos = index.load(std::memory_order_relaxed); //被别人抢先认领了
+        }
+    }
+
+    template<class T, class Alloc>
+    template<class... Args>
+    bool mpmc_queue<T, Alloc>::try_emplace(Args&&... args) {
+        size_type pos;
+        if (claim(enqueue_pos, 1, 0, pos) == 0) return false;
+        cell& c = cells[pos & mask];
+        ::new (c.value()) T(std::forward<Args>(args)...);
+        c.seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<class T, class Alloc>
+    bool mpmc_queue<T, Alloc>::try_pop(value_type &out) {
+        size_type pos;
+        if (claim(dequeue_pos, 1, 1, pos) == 0) return false;
+        cell& c = cells[pos & mask];
+        out = std::move(*c.value());
+        STL::destroy(c.value());
+        //下一轮生产者在这个槽位上等的序号是pos + 容量
+        c.seq.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<class T, class Alloc>
+    template<class InputIterator>
+    typename mpmc_queue<T, Alloc>::size_type mpmc_queue<T, Alloc>::try_push_n(InputIterator first, size_type n) {
+        size_type pos;
+        if (n == 0) return 0;
+        const size_type k = claim(enqueue_pos, n, 0, pos);
+        for (size_type i = 0; i < k; ++ i, ++ first) {
+            cell& c = cells[(pos + i) & mask];
+            ::new (c.value()) T(*first);
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return k;
+    }
+
+    template<class T, class Alloc>
+    template<class OutputIterator>
+    typename mpmc_queue<T, Alloc>::size_type mpmc_queue<T, Alloc>::try_pop_n(OutputIterator out, size_type n) {
+        size_type pos;
+        if (n == 0) return 0;
+        const size_type k = claim(dequeue_pos, n, 1, pos);
+        for (size_type i = 0; i < k; ++ i, ++ out) {
+            cell& c = cells[(pos + i) & mask];
+            *out = std::move(*c.value());
+            STL::destroy(c.value());
+            c.seq.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        return k;
+    }
+}
+
+#endif //MY_TINY_STL_CONCURRENT_QUEUE_H
@@ -3,12 +3,15 @@
 #define MY_TINY_STL_CONSTRUCT_H
 
 #include "type_traits.h"
+#include "iterator.h"
 #include <new>
+#include <utility>
 
 namespace STL {
-    template<typename T1, typename T2>
-    void construct(T1* p, const T2& value) {
-        new(p) T1(value);
+    //在p处用args原样转发构造T1，右值参数触发移动构造，无参数时值初始化
+    template<typename T1, typename... Args>
+    void construct(T1* p, Args&&... args) {
+        new(static_cast<void*>(p)) T1(std::forward<Args>(args)...);
     }
     //析构函数的两个版本
     template<typename T>
@@ -21,20 +24,21 @@ namespace STL {
 
     template<class ForwordIterator>
     void __destroy_aux(ForwordIterator first, ForwordIterator last, __false_type) {
-        for (; first < last; ++ first) {
+        for (; first != last; ++ first) {
             destroy(& (*first));
         }
     }
 
-    template<class ForwordIterator>
-    void __destroy(ForwordIterator first, ForwordIterator last) {
-        typedef typename STL::__type_traits<ForwordIterator>::has_trivial_destructor trivial_destructor;
+    //按元素类型(而不是迭代器类型)判断析构是否平凡
+    template<class ForwordIterator, class T>
+    void __destroy(ForwordIterator first, ForwordIterator last, T*) {
+        typedef typename STL::__type_traits<T>::has_trivial_destructor trivial_destructor;
         __destroy_aux(first, last, trivial_destructor());
     }
 
     template<class ForwordIterator>
     void destroy(ForwordIterator first, ForwordIterator last) {
-        __destroy(first, last);
+        __destroy(first, last, value_type(first));
     }
 
 
@@ -7,11 +7,28 @@
 #include "construct.h"
 #include "iterator.h"
 #include "algorithm.h"
+#include "uninitialized.h"
 
 namespace STL {
 
-    size_t deque_buf_size(size_t n, size_t sz) {
-        return n != 0 ? n : (sz < 512 ? size_t(512/ sz) : size_t(1));
+    //缓存区默认的字节数，可在编译时用-D改为4096等页大小
+#ifndef MY_TINY_STL_DEQUE_BLOCK_BYTES
+#define MY_TINY_STL_DEQUE_BLOCK_BYTES 512
+#endif
+    //每个缓存区至少放这么多元素，大元素也有足够的扇出，不至于每个元素一个缓存区
+    enum{ __DEQUE_MIN_BLOCK_ELEMS = 8 };
+
+    /*
+     * bytes字节的缓存区能放的元素个数，至少__DEQUE_MIN_BLOCK_ELEMS个
+     * 是constexpr，可作为deque的BufSiz参数按字节指定缓存区：deque<T, allocator<T>, deque_block_size(4096, sizeof(T))>
+     */
+    constexpr size_t deque_block_size(size_t bytes, size_t sz) {
+        return bytes / sz > size_t(__DEQUE_MIN_BLOCK_ELEMS) ? bytes / sz : size_t(__DEQUE_MIN_BLOCK_ELEMS);
+    }
+
+    //BufSiz不为0时就是每个缓存区的元素个数
+    constexpr size_t deque_buf_size(size_t n, size_t sz) {
+        return n != 0 ? n : deque_block_size(MY_TINY_STL_DEQUE_BLOCK_BYTES, sz);
     }
 
     template<class T, size_t BufSiz=0>
@@ -40,7 +57,7 @@ namespace STL {
 
         reference operator*() { return *cur;}
         pointer operator->() { return &(operator*());}
-        difference_type operator-(self& x) {
+        difference_type operator-(const self& x) const {
             return difference_type(buf_size()) * (node - x.node - 1) + (cur - first) + (x.last - x.cur);
         }
 
@@ -103,12 +120,38 @@ namespace STL {
             return *(*this + n);
         }
 
-        bool operator==(self& x) {return x.cur == cur;}
-        bool operator!=(self& x) {return !(x == *this);}
-        bool operator<(self& x) {
+        bool operator==(const self& x) const {return x.cur == cur;}
+        bool operator!=(const self& x) const {return !(x == *this);}
+        bool operator<(const self& x) const {
             return node == x.node ? (cur < x.cur) : (node < x.node);
         }
-        bool operator<=(self& x) {return x == *this || x < *this;}
+        bool operator<=(const self& x) const {return !(x < *this);}
+    };
+
+    //deque的每个缓存区是一段
+    template<class T, size_t BufSiz>
+    struct segmented_iterator_traits<deque_iterator<T, BufSiz>> {
+        typedef std::true_type              is_segmented;
+        typedef deque_iterator<T, BufSiz>   iterator;
+        typedef T**                         segment_iterator;
+        typedef T*                          local_iterator;
+
+        static segment_iterator segment(const iterator& it) { return it.node; }
+        static local_iterator local(const iterator& it) { return it.cur; }
+        static local_iterator begin(segment_iterator s) { return *s; }
+        static local_iterator end(segment_iterator s) { return *s + iterator::buf_size(); }
+        static iterator compose(segment_iterator s, local_iterator l) {
+            iterator it;
+            if (l == end(s)) {
+                it.set_node(s + 1);
+                it.cur = it.first;
+            }
+            else {
+                it.set_node(s);
+                it.cur = l;
+            }
+            return it;
+        }
     };
 
     template <class T, class Alloc=allocator<T>, size_t BufSiz=0>
@@ -120,15 +163,27 @@ namespace STL {
         typedef size_t                      size_type;
         typedef T*                          pointer;
         typedef ptrdiff_t                   difference_type;
-        typedef allocator<T*>               map_allocator;
-        typedef allocator<T>                data_allocator;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<T>  allocator_type;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<T*> map_allocator;
+        typedef allocator_type              data_allocator;
     protected:
         typedef pointer*                    map_pointer;
+        typedef allocator_traits<data_allocator> data_traits;
+        typedef allocator_traits<map_allocator>  map_traits;
 
         iterator start;
         iterator finish;
         map_pointer map;
         size_type map_size;
+        /*
+         * 备用缓存区：头尾弹空的缓存区先留在这里，push需要新缓存区时优先取用，
+         * 先进先出的稳定状态下push_back_aux与pop_front_aux互相抵消，不再调用配置器
+         */
+        enum{ spare_limit = 4 };
+        pointer spare[spare_limit];
+        size_type spare_count;
+        data_allocator data_alloc; //容器持有的配置器实例，map_alloc由它rebind而来
+        map_allocator map_alloc;
 
     public:
         //元素访问，与大小
@@ -160,28 +215,118 @@ namespace STL {
         //内存与构造相关
 
         //默认构造函数
-        deque() : start(), finish(), map(0), map_size(0){
+        deque() : start(), finish(), map(0), map_size(0), spare_count(0){
+            fill_initialize(0,T());
+        }
+        explicit deque(const allocator_type& a)
+                : start(), finish(), map(0), map_size(0), spare_count(0), data_alloc(a), map_alloc(a) {
             fill_initialize(0,T());
         }
         //预设n个val
-        deque(int n, const value_type& val) : start(), finish(), map(0), map_size(0){
+        deque(int n, const value_type& val, const allocator_type& a = allocator_type())
+                : start(), finish(), map(0), map_size(0), spare_count(0), data_alloc(a), map_alloc(a) {
             fill_initialize(n, val); //调用内部封装函数
         }
+        deque(const deque& rhs) : deque(rhs, data_traits::select_on_container_copy_construction(rhs.data_alloc)) {}
+        deque(const deque& rhs, const allocator_type& a)
+                : start(), finish(), map(0), map_size(0), spare_count(0), data_alloc(a), map_alloc(a) {
+            deque& src = const_cast<deque&>(rhs); //迭代器只提供非const接口
+            creat_map_and_node(src.size());
+            STL::uninitialized_copy(src.begin(), src.end(), start);
+        }
+        //移动构造接管rhs的map与缓存区，rhs换上一个新的空map，仍然可用
+        deque(deque&& rhs)
+                : start(), finish(), map(0), map_size(0), spare_count(0),
+                  data_alloc(std::move(rhs.data_alloc)), map_alloc(std::move(rhs.map_alloc)) {
+            creat_map_and_node(0);
+            swap_storage(rhs);
+        }
+        //配置器与rhs的不相等时逐个移动元素
+        deque(deque&& rhs, const allocator_type& a)
+                : start(), finish(), map(0), map_size(0), spare_count(0), data_alloc(a), map_alloc(a) {
+            if (data_traits::equal(data_alloc, rhs.data_alloc)) {
+                creat_map_and_node(0);
+                swap_storage(rhs);
+            }
+            else {
+                creat_map_and_node(rhs.size());
+                STL::__uninitialized_move_if_noexcept(rhs.begin(), rhs.end(), start);
+                rhs.clear();
+            }
+        }
+        deque& operator=(const deque& rhs) {
+            if (this != &rhs) {
+                deque tmp(rhs, data_traits::propagate_on_container_copy_assignment::value ? rhs.data_alloc : data_alloc);
+                swap_all(tmp);
+            }
+            return *this;
+        }
+        //按propagate_on_container_move_assignment决定用谁的配置器，配置器相等时直接接管rhs的空间
+        deque& operator=(deque&& rhs) {
+            if (this != &rhs) {
+                if (data_traits::propagate_on_container_move_assignment::value) {
+                    deque tmp(std::move(rhs));
+                    swap_all(tmp);
+                }
+                else {
+                    deque tmp(std::move(rhs), data_alloc);
+                    swap_storage(tmp);
+                }
+            }
+            return *this;
+        }
+        ~deque() {
+            if (map) {
+                clear();
+                deallocate_node(start.first); //clear后只剩一个缓存区
+                shrink_to_fit();
+                map_traits::deallocate(map_alloc, map, map_size);
+            }
+        }
+
+        allocator_type get_allocator() const { return data_alloc; }
+
+        //把备用缓存区归还配置器
+        void shrink_to_fit() {
+            while (spare_count != 0) deallocate_node(spare[-- spare_count]);
+        }
+
+        void swap(deque& rhs) {
+            swap_storage(rhs);
+            STL::__alloc_on_swap(data_alloc, rhs.data_alloc);
+            STL::__alloc_on_swap(map_alloc, rhs.map_alloc);
+        }
 
         void push_back(const value_type& val) {
+            emplace_back(val);
+        }
+        void push_back(value_type&& val) {
+            emplace_back(std::move(val));
+        }
+        template <class... Args>
+        reference emplace_back(Args&&... args) {
             //缓存区还有备用空间
             if (finish.cur != finish.last - 1) {
-                construct(finish.cur, val);
+                data_traits::construct(data_alloc, finish.cur, std::forward<Args>(args)...);
                 ++ finish.cur;
             }
-            else push_back_aux(val);
+            else push_back_aux(std::forward<Args>(args)...);
+            return back();
         }
         void push_front(const value_type& val) {
+            emplace_front(val);
+        }
+        void push_front(value_type&& val) {
+            emplace_front(std::move(val));
+        }
+        template <class... Args>
+        reference emplace_front(Args&&... args) {
             if (start.cur != start.first) {
-                construct(start.cur - 1, val);
+                data_traits::construct(data_alloc, start.cur - 1, std::forward<Args>(args)...);
                 -- start.cur;
             }
-            else push_front_aux(val);
+            else push_front_aux(std::forward<Args>(args)...);
+            return front();
         }
         void pop_back() {
             if (finish.cur != finish.first) {
@@ -201,14 +346,17 @@ namespace STL {
         }
 
         void clear() {
-            for (map_pointer node = start.node + 1; node < finish.node; ++ node) {
-                destroy(*node, *node + buf_size());
-                deallocate_node(*node);
+            //元素可平凡析构时destroy是空操作，中间的缓存区只需归还；deallocate也是空操作时连循环都省掉
+            if (!data_traits::template trivial_discard<T>::value) {
+                for (map_pointer node = start.node + 1; node < finish.node; ++ node) {
+                    destroy(*node, *node + buf_size());
+                    release_node(*node);
+                }
             }
             if (start.node != finish.node) { //至少有头尾两个缓存区
                 destroy(start.cur, start.last);
                 destroy(finish.first, finish.cur);
-                deallocate_node(finish.first); //仅回收尾部
+                release_node(finish.first); //仅回收尾部
             }
             else {
                 destroy(start.cur, finish.cur); //仅析构，不释放
@@ -221,11 +369,11 @@ namespace STL {
             ++next;
             difference_type index = pos - start; //清除点之前的点数
             if (index < (size() >> 1)) { //如果清除点前面的元素较少，就移动之前的点
-                copy_backward(start, pos, next);
+                STL::move_backward(start, pos, next);
                 pop_front();
             }
             else { //移动之后的
-                copy(next, finish, pos);
+                STL::move(next, finish, pos);
                 pop_back();
             }
             return start + index;
@@ -239,21 +387,21 @@ namespace STL {
                 difference_type n = last - first;   //清除区间长度
                 difference_type ele_before = first - start; //清除区间前方长度
                 if (ele_before < (size() - n) / 2) {
-                    copy_backward(start, first, last);
+                    STL::move_backward(start, first, last);
                     iterator new_start = start + n;
                     destroy(start, new_start);
                     //将以下冗余空间释放
                     for (map_pointer cur = start.node; cur < new_start.node; ++ cur) {
-                        deallocate_node(*cur);
+                        release_node(*cur);
                     }
                     start = new_start;
                 }
                 else {
-                    copy(last, finish, first);
+                    STL::move(last, finish, first);
                     iterator new_finish = finish - n;
                     destroy(new_finish, finish);
                     for (map_pointer cur = new_finish.node + 1; cur <= finish.node; ++ cur) {
-                        deallocate_node(*cur);
+                        release_node(*cur);
                     }
                     finish = new_finish;
                 }
@@ -261,16 +409,23 @@ namespace STL {
             }
         }
         iterator insert(iterator pos, const value_type& val) {
+            return emplace(pos, val);
+        }
+        iterator insert(iterator pos, value_type&& val) {
+            return emplace(pos, std::move(val));
+        }
+        template <class... Args>
+        iterator emplace(iterator pos, Args&&... args) {
             if (pos.cur == start.cur) {
-                push_front(val);
+                emplace_front(std::forward<Args>(args)...);
                 return start;
             }
             else if (pos.cur == finish.cur) {
-                push_back(val);
+                emplace_back(std::forward<Args>(args)...);
                 return finish - 1;
             }
             else {
-                return insert_aux(pos, val);
+                return insert_aux(pos, std::forward<Args>(args)...);
             }
         }
     private:
@@ -280,7 +435,7 @@ namespace STL {
             size_type num_nodes = num_elements / buf_size() + 1;
 
             map_size = max(size_type(2), num_nodes + 2); //+2是为了让前后都有扩充的空间
-            map = map_allocator::allocate(map_size);
+            map = map_traits::allocate(map_alloc, map_size);
 
             //将start与finish设在缓存区中间的位置，这样两头可扩充大小就相等
             map_pointer nstart = map + (map_size - num_nodes) / 2;
@@ -300,32 +455,34 @@ namespace STL {
         void fill_initialize(size_type n, const value_type& val) {
             creat_map_and_node(n);
             for (map_pointer cur = start.node; cur < finish.node; ++ cur)
-                uninitialized_fill(*cur, *cur + buf_size(), val);
-            uninitialized_fill(finish.first, finish.cur, val);
+                STL::uninitialized_fill(*cur, *cur + buf_size(), val);
+            STL::uninitialized_fill(finish.first, finish.cur, val);
         }
         //push_back重分配款
-        void push_back_aux(const value_type& val) {
+        template <class... Args>
+        void push_back_aux(Args&&... args) {
             reserve_map_at_back();
-            *(finish.node + 1) = allocate_node();
-            construct(finish.cur, val); //构造
+            *(finish.node + 1) = acquire_node();
+            data_traits::construct(data_alloc, finish.cur, std::forward<Args>(args)...); //构造
 
             //修改finish的信息
             finish.set_node(finish.node + 1);
             finish.cur = finish.first;
         }
         //push_front重新分配款
-        void push_front_aux(const value_type& val) {
+        template <class... Args>
+        void push_front_aux(Args&&... args) {
             reserve_map_at_front();
-            *(start.node - 1) = allocate_node();
+            *(start.node - 1) = acquire_node();
 
             //修改finish的信息
             start.set_node(start.node - 1);
             start.cur = start.last - 1;
-            construct(start.cur, val); //构造
+            data_traits::construct(data_alloc, start.cur, std::forward<Args>(args)...); //构造
         }
         //pop_back 内存管理版
         void pop_back_aux() {
-            deallocate_node(finish.first);
+            release_node(finish.first);
             finish.set_node(finish.node - 1);
             finish.cur = finish.last - 1;
             destroy(finish.cur);
@@ -334,22 +491,26 @@ namespace STL {
         void pop_front_aux() {
             destroy(start.cur);
 
-            deallocate_node(start.first);
+            release_node(start.first);
             start.set_node(start.node + 1);
             start.cur = start.first;
         }
         //insert实现
-        iterator insert_aux(iterator pos, const value_type & val) {
+        //push_front/push_back之后原来的pos可能失效，按下标重新定位
+        template <class... Args>
+        iterator insert_aux(iterator pos, Args&&... args) {
             difference_type index = pos - start;
+            value_type x_copy(std::forward<Args>(args)...); //args可能引用容器中的元素
             if (index < size() / 2) { //插入点之前的元素较少
-                push_front(front());
-                copy(start + 2, start + index + 1, start + 1);
+                push_front(std::move(front()));
+                STL::move(start + 2, start + index + 1, start + 1);
             }
             else {
-                push_back(back());
-                copy_backward(start + index, finish - 2, finish - 1);
+                push_back(std::move(back()));
+                STL::move_backward(start + index, finish - 2, finish - 1);
             }
-            *pos = val;
+            pos = start + index;
+            *pos = std::move(x_copy);
             return pos;
         }
         //若back满足条件就重新分配map
@@ -374,21 +535,21 @@ namespace STL {
                 //调整原来的map，不重新分配
                 new_nstart = map + (map_size - new_num_nodes) / 2 + (add_at_front ? nodes_to_add : 0);
                 if (new_nstart < start.node) {
-                    copy(start.node, finish.node + 1, new_nstart);
+                    STL::copy(start.node, finish.node + 1, new_nstart);
                 }
                 else {
-                    copy_backward(start.node, finish.node + 1, new_nstart + old_num_nodes);
+                    STL::copy_backward(start.node, finish.node + 1, new_nstart + old_num_nodes);
                 }
             }
             else {  //重新分配
                 size_type new_map_size = map_size + max(map_size, nodes_to_add) + 2;
-                map_pointer new_map = map_allocator ::allocate(new_map_size);
+                map_pointer new_map = map_traits::allocate(map_alloc, new_map_size);
                 new_nstart = new_map + (new_map_size - new_num_nodes) / 2
                         + (add_at_front ? nodes_to_add : 0);
                 //把原map内容拷贝
-                copy(start.node, finish.node + 1, new_nstart);
+                STL::copy(start.node, finish.node + 1, new_nstart);
                 //释放原map
-                map_allocator ::deallocate(map, map_size);
+                map_traits::deallocate(map_alloc, map, map_size);
                 //设置新map
                 map = new_map;
                 map_size = new_map_size;
@@ -400,11 +561,34 @@ namespace STL {
         }
         //给node分配空间
         pointer allocate_node() {
-            return data_allocator::allocate(buf_size());
+            return data_traits::allocate(data_alloc, buf_size());
         }
         //把node的空间释放
         void deallocate_node(pointer x) {
-            data_allocator::deallocate(x, buf_size());
+            data_traits::deallocate(data_alloc, x, buf_size());
+        }
+        //优先取备用缓存区
+        pointer acquire_node() {
+            return spare_count != 0 ? spare[-- spare_count] : allocate_node();
+        }
+        //备用缓存区未满时留下，否则归还
+        void release_node(pointer x) {
+            if (spare_count != spare_limit) spare[spare_count ++] = x;
+            else deallocate_node(x);
+        }
+        void swap_storage(deque& rhs) {
+            STL::swap(start, rhs.start);
+            STL::swap(finish, rhs.finish);
+            STL::swap(map, rhs.map);
+            STL::swap(map_size, rhs.map_size);
+            for (size_type i = 0; i < STL::max(spare_count, rhs.spare_count); ++ i) STL::swap(spare[i], rhs.spare[i]);
+            STL::swap(spare_count, rhs.spare_count);
+        }
+        //连同配置器一起交换，用于赋值
+        void swap_all(deque& rhs) {
+            swap_storage(rhs);
+            STL::swap(data_alloc, rhs.data_alloc);
+            STL::swap(map_alloc, rhs.map_alloc);
         }
     };
 }
@@ -0,0 +1,446 @@
+#ifndef MY_TINY_STL_DYNAMIC_BITSET_H
+#define MY_TINY_STL_DYNAMIC_BITSET_H
+#include <cstring>
+#include "allocator.h"
+#include "algorithm.h"
+#include "vector.h"
+
+namespace STL {
+    typedef unsigned long long __bit_word;
+    enum{ __BITS_PER_WORD = 64 };
+
+    inline size_t __popcount(__bit_word w) {
+#if defined(__GNUC__)
+        return size_t(__builtin_popcountll(w));
+#else
+        w = w - ((w >> 1) & 0x5555555555555555ULL);
+        w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+        w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        return size_t((w * 0x0101010101010101ULL) >> 56);
+#endif
+    }
+
+    //最低位的1的位置，w不为0
+    inline size_t __ctz(__bit_word w) {
+#if defined(__GNUC__)
+        return size_t(__builtin_ctzll(w));
+#else
+        size_t k = 0;
+        while ((w & 1) == 0) w >>= 1, ++ k;
+        return k;
+#endif
+    }
+
+    //w中第k个(从0数)1的位置，w中至少有k+1个1
+    inline size_t __select_in_word(__bit_word w, size_t k) {
+        for (; k > 0; -- k) w &= w - 1;
+        return __ctz(w);
+    }
+
+    /*
+     * 按位打包的动态位集，每64位存成一个字，字由配置器Alloc分配
+     * 与、或、异或、取反、计数、查找都按字进行，简单的逐字循环由编译器向量化
+     * 最后一个字中超出size()的位始终为0，count、find、比较不必另外处理
+     * 配合bitset_rank_select可在O(1)时间求rank、O(log n)时间求select
+     */
+    template <class Alloc = allocator<__bit_word>>
+    class dynamic_bitset {
+    public:
+        typedef __bit_word  word_type;
+        typedef size_t      size_type;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<word_type> allocator_type;
+
+        enum{ bits_per_word = __BITS_PER_WORD };
+        static const size_type npos = size_type(-1);
+
+    private:
+        typedef allocator_traits<allocator_type> alloc_traits;
+        word_type* words;
+        size_type nbits;
+        size_type cap; //已分配的字数
+        allocator_type data_alloc;
+
+        static size_type words_for(size_type n) { return (n + bits_per_word - 1) / bits_per_word; }
+        static word_type bit_mask(size_type pos) { return word_type(1) << (pos % bits_per_word); }
+        size_type num_words() const { return words_for(nbits); }
+        //把最后一个字中超出size()的位清零
+        void clear_tail();
+        void grow_to(size_type nwords);
+
+    public:
+        //构造函数，复制构造函数，析构函数
+        dynamic_bitset() : words(nullptr), nbits(0), cap(0) {}
+        explicit dynamic_bitset(size_type n, bool value = false, const allocator_type& a = allocator_type());
+        dynamic_bitset(const dynamic_bitset& b);
+        dynamic_bitset(dynamic_bitset&& b) noexcept;
+        ~dynamic_bitset();
+        dynamic_bitset& operator=(const dynamic_bitset& b);
+        dynamic_bitset& operator=(dynamic_bitset&& b) noexcept;
+        void swap(dynamic_bitset& b) noexcept;
+
+        //容量相关
+        size_type size() const { return nbits; }
+        bool empty() const { return nbits == 0; }
+        size_type word_count() const { return num_words(); }
+        const word_type* data() const { return words; }
+        word_type* data() { return words; }
+        void resize(size_type n, bool value = false);
+        void reserve(size_type n);
+        void push_back(bool value);
+        void clear() { nbits = 0; }
+
+        //单个位
+        bool test(size_type pos) const { return (words[pos / bits_per_word] & bit_mask(pos)) != 0; }
+        bool operator[](size_type pos) const { return test(pos); }
+        dynamic_bitset& set(size_type pos) { words[pos / bits_per_word] |= bit_mask(pos); return *this; }
+        dynamic_bitset& set(size_type pos, bool value) { return value ? set(pos) : reset(pos); }
+        dynamic_bitset& reset(size_type pos) { words[pos / bits_per_word] &= ~bit_mask(pos); return *this; }
+        dynamic_bitset& flip(size_type pos) { words[pos / bits_per_word] ^= bit_mask(pos); return *this; }
+        //测试并置位，返回原来的值，用于visited集合
+        bool test_set(size_type pos);
+
+        //整体与区间
+        dynamic_bitset& set();
+        dynamic_bitset& reset();
+        dynamic_bitset& flip();
+        //把[first, last)全部置为value，中间的整字直接填充
+        dynamic_bitset& set_range(size_type first, size_type last, bool value = true);
+        dynamic_bitset& reset_range(size_type first, size_type last) { return set_range(first, last, false); }
+
+        //计数与查找
+        size_type count() const;
+        bool any() const;
+        bool none() const { return !any(); }
+        bool all() const { return count() == nbits; }
+        //第一个1的位置，没有时返回npos
+        size_type find_first() const { return nbits == 0 ? npos : find_from(0); }
+        //pos之后(不含pos)第一个1的位置，没有时返回npos
+        size_type find_next(size_type pos) const { return pos + 1 >= nbits ? npos : find_from(pos + 1); }
+        size_type find_from(size_type pos) const;
+
+        //逐字运算，两边size()须相同
+        dynamic_bitset& operator&=(const dynamic_bitset& b);
+        dynamic_bitset& operator|=(const dynamic_bitset& b);
+        dynamic_bitset& operator^=(const dynamic_bitset& b);
+        //差集：清除b中为1的位
+        dynamic_bitset& operator-=(const dynamic_bitset& b);
+        dynamic_bitset operator~() const { dynamic_bitset r(*this); return r.flip(); }
+
+        bool operator==(const dynamic_bitset& b) const;
+        bool operator!=(const dynamic_bitset& b) const { return !(*this == b); }
+    };
+
+    template <class Alloc>
+    const typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::npos;
+
+    template <class Alloc>
+    dynamic_bitset<Alloc> operator&(const dynamic_bitset<Alloc>& a, const dynamic_bitset<Alloc>& b) {
+        dynamic_bitset<Alloc> r(a);
+        return r &= b;
+    }
+    template <class Alloc>
+    dynamic_bitset<Alloc> operator|(const dynamic_bitset<Alloc>& a, const dynamic_bitset<Alloc>& b) {
+        dynamic_bitset<Alloc> r(a);
+        return r |= b;
+    }
+    template <class Alloc>
+    dynamic_bitset<Alloc> operator^(const dynamic_bitset<Alloc>& a, const dynamic_bitset<Alloc>& b) {
+        dynamic_bitset<Alloc> r(a);
+        return r ^= b;
+    }
+
+    //构造，析构，赋值
+    template<class Alloc>
+    dynamic_bitset<Alloc>::dynamic_bitset(size_type n, bool value, const allocator_type& a)
+            : words(nullptr), nbits(0), cap(0), data_alloc(a) {
+        resize(n, value);
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>::dynamic_bitset(const dynamic_bitset &b)
+            : words(nullptr), nbits(0), cap(0),
+              data_alloc(alloc_traits::select_on_container_copy_construction(b.data_alloc)) {
+        grow_to(b.num_words());
+        if (b.num_words() != 0) memcpy(words, b.words, b.num_words() * sizeof(word_type));
+        nbits = b.nbits;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>::dynamic_bitset(dynamic_bitset &&b) noexcept
+            : words(b.words), nbits(b.nbits), cap(b.cap), data_alloc(std::move(b.data_alloc)) {
+        b.words = nullptr;
+        b.nbits = b.cap = 0;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>::~dynamic_bitset() {
+        if (words) alloc_traits::deallocate(data_alloc, words, cap);
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator=(const dynamic_bitset &b) {
+        if (this != &b) {
+            dynamic_bitset tmp(b);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator=(dynamic_bitset &&b) noexcept {
+        if (this != &b) swap(b);
+        return *this;
+    }
+
+    template<class Alloc>
+    void dynamic_bitset<Alloc>::swap(dynamic_bitset &b) noexcept {
+        STL::swap(words, b.words);
+        STL::swap(nbits, b.nbits);
+        STL::swap(cap, b.cap);
+        STL::swap(data_alloc, b.data_alloc);
+    }
+
+    //容量相关
+    template<class Alloc>
+    void dynamic_bitset<Alloc>::grow_to(size_type nwords) {
+        if (nwords <= cap) return;
+        //字是可平凡复制的，交给配置器reallocate，可能原地增长
+        words = alloc_traits::reallocate(data_alloc, words, cap, nwords);
+        cap = nwords;
+    }
+
+    template<class Alloc>
+    void dynamic_bitset<Alloc>::clear_tail() {
+        if (nbits % bits_per_word != 0)
+            words[nbits / bits_per_word] &= (word_type(1) << (nbits % bits_per_word)) - 1;
+    }
+
+    template<class Alloc>
+    void dynamic_bitset<Alloc>::reserve(size_type n) {
+        grow_to(words_for(n));
+    }
+
+    template<class Alloc>
+    void dynamic_bitset<Alloc>::resize(size_type n, bool value) {
+        const size_type old_bits = nbits;
+        const size_type old_words = num_words();
+        const size_type new_words = words_for(n);
+        if (new_words > cap) grow_to(STL::max(new_words, cap * 2));
+        //新增的整字先清零，旧的最后一个字中超出size()的位本来就是0
+        if (new_words > old_words) memset(words + old_words, 0, (new_words - old_words) * sizeof(word_type));
+        nbits = n;
+        if (n > old_bits && value) set_range(old_bits, n);
+        clear_tail();
+    }
+
+    template<class Alloc>
+    void dynamic_bitset<Alloc>::push_back(bool value) {
+        if (nbits % bits_per_word == 0) {
+            if (num_words() == cap) grow_to(cap == 0 ? 1 : cap * 2);
+            words[num_words()] = 0;
+        }
+        ++ nbits;
+        if (value) set(nbits - 1);
+    }
+
+    template<class Alloc>
+    bool dynamic_bitset<Alloc>::test_set(size_type pos) {
+        word_type& w = words[pos / bits_per_word];
+        const word_type m = bit_mask(pos);
+        const bool old = (w & m) != 0;
+        w |= m;
+        return old;
+    }
+
+    //整体与区间
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::set() {
+        if (nbits != 0) memset(words, 0xFF, num_words() * sizeof(word_type));
+        clear_tail();
+        return *this;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::reset() {
+        if (nbits != 0) memset(words, 0, num_words() * sizeof(word_type));
+        return *this;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::flip() {
+        const size_type n = num_words();
+        for (size_type i = 0; i < n; ++ i) words[i] = ~words[i];
+        clear_tail();
+        return *this;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::set_range(size_type first, size_type last, bool value) {
+        if (first >= last) return *this;
+        const size_type fw = first / bits_per_word, lw = (last - 1) / bits_per_word;
+        const word_type head = ~word_type(0) << (first % bits_per_word);
+        const word_type tail = ~word_type(0) >> (bits_per_word - 1 - (last - 1) % bits_per_word);
+        if (fw == lw) {
+            if (value) words[fw] |= head & tail;
+            else words[fw] &= ~(head & tail);
+            return *this;
+        }
+        if (value) {
+            words[fw] |= head;
+            words[lw] |= tail;
+        }
+        else {
+            words[fw] &= ~head;
+            words[lw] &= ~tail;
+        }
+        if (lw > fw + 1) memset(words + fw + 1, value ? 0xFF : 0, (lw - fw - 1) * sizeof(word_type));
+        return *this;
+    }
+
+    //计数与查找
+    template<class Alloc>
+    typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::count() const {
+        const size_type n = num_words();
+        size_type c = 0;
+        for (size_type i = 0; i < n; ++ i) c += __popcount(words[i]);
+        return c;
+    }
+
+    template<class Alloc>
+    bool dynamic_bitset<Alloc>::any() const {
+        const size_type n = num_words();
+        for (size_type i = 0; i < n; ++ i)
+            if (words[i] != 0) return true;
+        return false;
+    }
+
+    template<class Alloc>
+    typename dynamic_bitset<Alloc>::size_type dynamic_bitset<Alloc>::find_from(size_type pos) const {
+        if (pos >= nbits) return npos;
+        size_type i = pos / bits_per_word;
+        word_type w = words[i] & (~word_type(0) << (pos % bits_per_word)); //pos之前的位不算
+        const size_type n = num_words();
+        while (w == 0) {
+            if (++ i == n) return npos;
+            w = words[i];
+        }
+        return i * bits_per_word + __ctz(w);
+    }
+
+    //逐字运算
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator&=(const dynamic_bitset &b) {
+        const size_type n = num_words();
+        word_type* p = words;
+        const word_type* q = b.words;
+        for (size_type i = 0; i < n; ++ i) p[i] &= q[i];
+        return *this;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator|=(const dynamic_bitset &b) {
+        const size_type n = num_words();
+        word_type* p = words;
+        const word_type* q = b.words;
+        for (size_type i = 0; i < n; ++ i) p[i] |= q[i];
+        return *this;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator^=(const dynamic_bitset &b) {
+        const size_type n = num_words();
+        word_type* p = words;
+        const word_type* q = b.words;
+        for (size_type i = 0; i < n; ++ i) p[i] ^= q[i];
+        return *this;
+    }
+
+    template<class Alloc>
+    dynamic_bitset<Alloc>& dynamic_bitset<Alloc>::operator-=(const dynamic_bitset &b) {
+        const size_type n = num_words();
+        word_type* p = words;
+        const word_type* q = b.words;
+        for (size_type i = 0; i < n; ++ i) p[i] &= ~q[i];
+        return *this;
+    }
+
+    template<class Alloc>
+    bool dynamic_bitset<Alloc>::operator==(const dynamic_bitset &b) const {
+        return nbits == b.nbits && (nbits == 0 || memcmp(words, b.words, num_words() * sizeof(word_type)) == 0);
+    }
+
+    /*
+     * dynamic_bitset的rank/select辅助结构：每512位(8个字)记录此前1的个数，额外空间约为位集的1/8
+     * rank(i)为[0, i)中1的个数，select(k)为第k个(从0数)1的位置
+     * 建立之后位集不能再修改，否则需要重新build
+     */
+    template <class Alloc = allocator<__bit_word>>
+    class bitset_rank_select {
+    public:
+        typedef size_t size_type;
+        enum{ words_per_block = 8 };
+
+    private:
+        const dynamic_bitset<Alloc>* bits;
+        mutable vector<size_type> block_rank; //block_rank[j]为前j个块中1的个数，多存一项总数；vector没有const接口
+
+    public:
+        bitset_rank_select() : bits(nullptr) {}
+        explicit bitset_rank_select(const dynamic_bitset<Alloc>& b) { build(b); }
+        void build(const dynamic_bitset<Alloc>& b);
+        size_type rank(size_type pos) const;
+        size_type select(size_type k) const;
+        size_type ones() const { return block_rank.empty() ? 0 : block_rank.back(); }
+    };
+
+    template<class Alloc>
+    void bitset_rank_select<Alloc>::build(const dynamic_bitset<Alloc> &b) {
+        bits = &b;
+        const size_type n = b.word_count();
+        const __bit_word* w = b.data();
+        vector<size_type> ranks;
+        ranks.reserve(n / words_per_block + 2);
+        size_type total = 0;
+        for (size_type i = 0; i < n; ++ i) {
+            if (i % words_per_block == 0) ranks.push_back(total);
+            total += __popcount(w[i]);
+        }
+        ranks.push_back(total);
+        block_rank.swap(ranks);
+    }
+
+    template<class Alloc>
+    typename bitset_rank_select<Alloc>::size_type bitset_rank_select<Alloc>::rank(size_type pos) const {
+        const __bit_word* w = bits->data();
+        const size_type wi = pos / __BITS_PER_WORD;
+        size_type r = block_rank[wi / words_per_block];
+        for (size_type i = wi / words_per_block * words_per_block; i < wi; ++ i) r += __popcount(w[i]);
+        if (pos % __BITS_PER_WORD != 0)
+            r += __popcount(w[wi] & ((__bit_word(1) << (pos % __BITS_PER_WORD)) - 1));
+        return r;
+    }
+
+    template<class Alloc>
+    typename bitset_rank_select<Alloc>::size_type bitset_rank_select<Alloc>::select(size_type k) const {
+        if (k >= ones()) return dynamic_bitset<Alloc>::npos;
+        vector<size_type>& ranks = block_rank;
+        //最后一个block_rank不超过k的块
+        size_type lo = 0, hi = ranks.size() - 1;
+        while (hi - lo > 1) {
+            size_type mid = lo + (hi - lo) / 2;
+            if (ranks[mid] <= k) lo = mid;
+            else hi = mid;
+        }
+        k -= ranks[lo];
+        const __bit_word* w = bits->data();
+        size_type i = lo * words_per_block;
+        for (;; ++ i) {
+            size_type c = __popcount(w[i]);
+            if (k < c) break;
+            k -= c;
+        }
+        return i * __BITS_PER_WORD + __select_in_word(w[i], k);
+    }
+}
+
+#endif //MY_TINY_STL_DYNAMIC_BITSET_H
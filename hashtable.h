@@ -92,13 +92,13 @@ namespace STL {
 
 // forward declaration
 
-        template <class T, class HashFun, class KeyEqual>
+        template <class T, class HashFun, class KeyEqual, class Alloc = STL::allocator<T>>
         class hashtable;
 
-        template <class T, class HashFun, class KeyEqual>
+        template <class T, class HashFun, class KeyEqual, class Alloc>
         struct ht_iterator;
 
-        template <class T, class HashFun, class KeyEqual>
+        template <class T, class HashFun, class KeyEqual, class Alloc>
         struct ht_const_iterator;
 
         template <class T>
@@ -109,12 +109,12 @@ namespace STL {
 
 // ht_iterator
 
-        template <class T, class Hash, class KeyEqual>
+        template <class T, class Hash, class KeyEqual, class Alloc>
         struct ht_iterator_base :public STL::iterator<STL::forward_iterator_tag, T>
         {
-            typedef hashtable<T, Hash, KeyEqual>                hashtable;
-            typedef ht_iterator_base<T, Hash, KeyEqual>         base;
-            typedef ht_iterator<T, Hash, KeyEqual>              iterator;
+            typedef hashtable<T, Hash, KeyEqual, Alloc>                hashtable;
+            typedef ht_iterator_base<T, Hash, KeyEqual, Alloc>         base;
+            typedef ht_iterator<T, Hash, KeyEqual, Alloc>              iterator;
             typedef hashtable_node<T>*                          node_ptr;
             typedef hashtable*                                  contain_ptr;
 
@@ -130,10 +130,10 @@ namespace STL {
             bool operator!=(const base& rhs) const { return node != rhs.node; }
         };
 
-        template <class T, class Hash, class KeyEqual>
-        struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual>
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        struct ht_iterator :public ht_iterator_base<T, Hash, KeyEqual, Alloc>
         {
-            typedef ht_iterator_base<T, Hash, KeyEqual> base;
+            typedef ht_iterator_base<T, Hash, KeyEqual, Alloc> base;
             typedef typename base::hashtable            hashtable;
             typedef typename base::iterator             iterator;
             typedef typename base::node_ptr             node_ptr;
@@ -261,12 +261,12 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 模板类 hashtable
-// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数
-        template <class T, class Hash, class KeyEqual>
+// 参数一代表数据类型，参数二代表哈希函数，参数三代表键值相等的比较函数，参数四代表空间配置器
+        template <class T, class Hash, class KeyEqual, class Alloc>
         class hashtable
         {
 
-            friend struct STL::ht_iterator<T, Hash, KeyEqual>;
+            friend struct STL::ht_iterator<T, Hash, KeyEqual, Alloc>;
 
         public:
             // hashtable 的型别定义
@@ -279,28 +279,30 @@ static constexpr size_t ht_prime_list[] = {
 
             typedef hashtable_node<T>                           node_type;
             typedef node_type*                                  node_ptr;
-            typedef STL::vector<node_ptr>                     bucket_type;
-
-            typedef STL::allocator<T>                         allocator_type;
-            typedef STL::allocator<T>                         data_allocator;
-            typedef STL::allocator<node_type>                 node_allocator;
+            typedef typename allocator_traits<Alloc>::template rebind_alloc<T>         allocator_type;
+            typedef allocator_type                                                      data_allocator;
+            typedef typename allocator_traits<Alloc>::template rebind_alloc<node_type> node_allocator;
+            typedef typename allocator_traits<Alloc>::template rebind_alloc<node_ptr>  bucket_allocator;
+            typedef allocator_traits<node_allocator>            node_traits;
+            typedef STL::vector<node_ptr, bucket_allocator>     bucket_type;
 
             typedef typename allocator_type::pointer            pointer;
             typedef typename allocator_type::reference          reference;
             typedef typename allocator_type::size_type          size_type;
             typedef typename allocator_type::difference_type    difference_type;
 
-            typedef STL::ht_iterator<T, Hash, KeyEqual>       iterator;
-            allocator_type get_allocator() const { return allocator_type(); }
+            typedef STL::ht_iterator<T, Hash, KeyEqual, Alloc>       iterator;
+            allocator_type get_allocator() const { return allocator_type(node_alloc_); }
 
         private:
-            // 用以下六个参数来表现 hashtable
+            // 用以下七个参数来表现 hashtable
             bucket_type buckets_;
             size_type   bucket_size_;
             size_type   size_;
             float       mlf_{};
             hasher      hash_;
             key_equal   equal_;
+            node_allocator node_alloc_; // 容器持有的配置器实例，bucket 数组也由它 rebind 而来
 
         private:
             bool is_equal(const key_type& key1, const key_type& key2)
@@ -322,19 +324,44 @@ static constexpr size_t ht_prime_list[] = {
             // 构造、复制、移动、析构函数
             explicit hashtable(size_type bucket_count,
                                const Hash& hash = Hash(),
-                               const KeyEqual& equal = KeyEqual())
-                    :size_(0), mlf_(1.0f), hash_(hash), equal_(equal)
+                               const KeyEqual& equal = KeyEqual(),
+                               const allocator_type& a = allocator_type())
+                    :buckets_(bucket_allocator(a)), size_(0), mlf_(1.0f), hash_(hash), equal_(equal), node_alloc_(a)
             {
                 init(bucket_count);
             }
 
             hashtable(const hashtable& rhs)
-                    :hash_(rhs.hash_), equal_(rhs.equal_)
+                    :hashtable(rhs, allocator_type(node_traits::select_on_container_copy_construction(rhs.node_alloc_)))
+            {
+            }
+
+            hashtable(const hashtable& rhs, const allocator_type& a)
+                    :buckets_(bucket_allocator(a)), hash_(rhs.hash_), equal_(rhs.equal_), node_alloc_(a)
             {
                 copy_init(rhs);
             }
 
+            // 移动构造接管 rhs 的 bucket 数组与节点，rhs 换上一个最小的空表，仍然可用
+            hashtable(hashtable&& rhs)
+                    :buckets_(std::move(rhs.buckets_)), bucket_size_(rhs.bucket_size_), size_(rhs.size_),
+                     mlf_(rhs.mlf_), hash_(rhs.hash_), equal_(rhs.equal_), node_alloc_(std::move(rhs.node_alloc_))
+            {
+                rhs.size_ = 0;
+                rhs.init(0);
+            }
+
+            // 配置器与 rhs 的不相等时只能逐个移动元素
+            hashtable(hashtable&& rhs, const allocator_type& a)
+                    :buckets_(bucket_allocator(a)), bucket_size_(0), size_(0), mlf_(rhs.mlf_),
+                     hash_(rhs.hash_), equal_(rhs.equal_), node_alloc_(a)
+            {
+                if (node_traits::equal(node_alloc_, rhs.node_alloc_)) take(rhs);
+                else move_init(rhs);
+            }
+
             hashtable& operator=(const hashtable& rhs);
+            hashtable& operator=(hashtable&& rhs);
 
             ~hashtable() { clear(); }
 
@@ -429,6 +456,8 @@ static constexpr size_t ht_prime_list[] = {
             // init
             void      init(size_type n);
             void      copy_init(const hashtable& ht);
+            void      move_init(hashtable& ht);
+            void      take(hashtable& ht);
 
             // node
             template  <class ...Args>
@@ -458,24 +487,54 @@ static constexpr size_t ht_prime_list[] = {
 /*****************************************************************************************/
 
 // 复制赋值运算符
-        template <class T, class Hash, class KeyEqual>
-        hashtable<T, Hash, KeyEqual>&
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        hashtable<T, Hash, KeyEqual, Alloc>&
+        hashtable<T, Hash, KeyEqual, Alloc>::
         operator=(const hashtable& rhs)
         {
             if (this != &rhs)
             {
-                hashtable tmp(rhs);
-                swap(tmp);
+                clear(); // 先用原来的配置器释放节点，再按 propagate_on_container_copy_assignment 决定换不换
+                STL::__alloc_on_copy(node_alloc_, rhs.node_alloc_);
+                buckets_ = rhs.buckets_; // bucket 数组自己处理配置器的传播，内容由 copy_init 重写
+                hash_ = rhs.hash_;
+                equal_ = rhs.equal_;
+                copy_init(rhs);
             }
             return *this;
         }
 
 
+// 移动赋值运算符
+// propagate_on_container_move_assignment 为真或配置器相等时直接接管 rhs 的节点，否则逐个移动元素
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        hashtable<T, Hash, KeyEqual, Alloc>&
+        hashtable<T, Hash, KeyEqual, Alloc>::
+        operator=(hashtable&& rhs)
+        {
+            if (this != &rhs)
+            {
+                clear();
+                hash_ = rhs.hash_;
+                equal_ = rhs.equal_;
+                if (node_traits::propagate_on_container_move_assignment::value ||
+                    node_traits::equal(node_alloc_, rhs.node_alloc_))
+                {
+                    STL::__alloc_on_move(node_alloc_, rhs.node_alloc_);
+                    take(rhs);
+                }
+                else
+                {
+                    move_init(rhs);
+                }
+            }
+            return *this;
+        }
+
 // 在不需要重建表格的情况下插入新节点，键值不允许重复
-        template <class T, class Hash, class KeyEqual>
-        std::pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        std::pair<typename hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+        hashtable<T, Hash, KeyEqual, Alloc>::
         insert_unique_noresize(const value_type& value)
         {
             const auto n = hash(value_traits::get_key(value));
@@ -494,9 +553,9 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 在不需要重建表格的情况下插入新节点，键值允许重复
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::iterator
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::iterator
+        hashtable<T, Hash, KeyEqual, Alloc>::
         insert_multi_noresize(const value_type& value)
         {
             const auto n = hash(value_traits::get_key(value));
@@ -520,8 +579,8 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 删除迭代器所指的节点
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         erase(iterator position)
         {
             auto p = position.node;
@@ -559,9 +618,9 @@ static constexpr size_t ht_prime_list[] = {
 
 
 // 删除键值为 key 的节点
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::size_type
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::size_type
+        hashtable<T, Hash, KeyEqual, Alloc>::
         erase_multi(const key_type& key)
         {
             auto p = equal_range_multi(key);
@@ -573,9 +632,9 @@ static constexpr size_t ht_prime_list[] = {
             return 0;
         }
 
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::size_type
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::size_type
+        hashtable<T, Hash, KeyEqual, Alloc>::
         erase_unique(const key_type& key)
         {
             const auto n = hash(key);
@@ -610,12 +669,19 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 清空 hashtable
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         clear()
         {
             if (size_ != 0)
             {
+                // 节点的析构与归还都是空操作时只需清空 bucket 数组，不必沿链表逐个释放
+                if (node_traits::template trivial_discard<value_type>::value)
+                {
+                    STL::fill(buckets_.begin(), buckets_.end(), nullptr);
+                    size_ = 0;
+                    return;
+                }
                 for (size_type i = 0; i < bucket_size_; ++i)
                 {
                     node_ptr cur = buckets_[i];
@@ -632,9 +698,9 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 在某个 bucket 节点的个数
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::size_type
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::size_type
+        hashtable<T, Hash, KeyEqual, Alloc>::
         bucket_size(size_type n) const noexcept
         {
             size_type result = 0;
@@ -646,8 +712,8 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 重新对元素进行一遍哈希，插入到新的位置
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         rehash(size_type count)
         {
             auto n = ht_next_prime(count);
@@ -666,9 +732,9 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 查找键值为 key 的节点，返回其迭代器
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::iterator
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::iterator
+        hashtable<T, Hash, KeyEqual, Alloc>::
         find(const key_type& key)
         {
             const auto n = hash(key);
@@ -678,9 +744,9 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 查找键值为 key 出现的次数
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::size_type
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::size_type
+        hashtable<T, Hash, KeyEqual, Alloc>::
         count(const key_type& key) const
         {
             const auto n = hash(key);
@@ -694,10 +760,10 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 查找与键值 key 相等的区间，返回一个 pair，指向相等区间的首尾
-        template <class T, class Hash, class KeyEqual>
-        std::pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-                typename hashtable<T, Hash, KeyEqual>::iterator>
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        std::pair<typename hashtable<T, Hash, KeyEqual, Alloc>::iterator,
+                typename hashtable<T, Hash, KeyEqual, Alloc>::iterator>
+        hashtable<T, Hash, KeyEqual, Alloc>::
         equal_range_multi(const key_type& key)
         {
             const auto n = hash(key);
@@ -722,10 +788,10 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 
-        template <class T, class Hash, class KeyEqual>
-        std::pair<typename hashtable<T, Hash, KeyEqual>::iterator,
-                typename hashtable<T, Hash, KeyEqual>::iterator>
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        std::pair<typename hashtable<T, Hash, KeyEqual, Alloc>::iterator,
+                typename hashtable<T, Hash, KeyEqual, Alloc>::iterator>
+        hashtable<T, Hash, KeyEqual, Alloc>::
         equal_range_unique(const key_type& key)
         {
             const auto n = hash(key);
@@ -747,8 +813,8 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 交换 hashtable
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         swap(hashtable& rhs) noexcept
         {
             if (this != &rhs)
@@ -759,6 +825,7 @@ static constexpr size_t ht_prime_list[] = {
                 STL::swap(mlf_, rhs.mlf_);
                 STL::swap(hash_, rhs.hash_);
                 STL::swap(equal_, rhs.equal_);
+                STL::__alloc_on_swap(node_alloc_, rhs.node_alloc_);
             }
         }
 
@@ -766,8 +833,8 @@ static constexpr size_t ht_prime_list[] = {
 // helper function
 
 // init 函数
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         init(size_type n)
         {
             const auto bucket_nums = next_size(n);
@@ -779,8 +846,8 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // copy_init 函数
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         copy_init(const hashtable& ht)
         {
             bucket_size_ = 0;
@@ -808,16 +875,50 @@ static constexpr size_t ht_prime_list[] = {
 
         }
 
+// move_init 函数：用自己的配置器重建 ht 的每个节点并移动元素，ht 随后清空
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
+        move_init(hashtable& ht)
+        {
+            buckets_.assign(ht.bucket_size_, nullptr);
+            for (size_type i = 0; i < ht.bucket_size_; ++i)
+            {
+                node_ptr* link = &buckets_[i];
+                for (auto cur = ht.buckets_[i]; cur; cur = cur->next)
+                {
+                    *link = create_node(std::move(cur->value));
+                    link = &(*link)->next;
+                }
+            }
+            bucket_size_ = ht.bucket_size_;
+            mlf_ = ht.mlf_;
+            size_ = ht.size_;
+            ht.clear();
+        }
+
+// take 函数：两边配置器相等，直接接管 ht 的 bucket 数组与节点，调用前自己须为空，ht 换上最小的空表
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
+        take(hashtable& ht)
+        {
+            buckets_ = std::move(ht.buckets_);
+            bucket_size_ = ht.bucket_size_;
+            size_ = ht.size_;
+            mlf_ = ht.mlf_;
+            ht.size_ = 0;
+            ht.init(0);
+        }
+
 // create_node 函数
-        template <class T, class Hash, class KeyEqual>
+        template <class T, class Hash, class KeyEqual, class Alloc>
         template <class ...Args>
-        typename hashtable<T, Hash, KeyEqual>::node_ptr
-        hashtable<T, Hash, KeyEqual>::
+        typename hashtable<T, Hash, KeyEqual, Alloc>::node_ptr
+        hashtable<T, Hash, KeyEqual, Alloc>::
         create_node(Args&& ...args)
         {
-            node_ptr tmp = node_allocator::allocate(1);
+            node_ptr tmp = node_traits::allocate(node_alloc_, 1);
 
-                data_allocator::construct(std::addressof(tmp->value), std::forward<Args>(args)...);
+                node_traits::construct(node_alloc_, std::addressof(tmp->value), std::forward<Args>(args)...);
                 tmp->next = nullptr;
 
 
@@ -825,43 +926,43 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // destroy_node 函数
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         destroy_node(node_ptr node)
         {
-            data_allocator::destroy(std::addressof(node->value));
-            node_allocator::deallocate(node);
+            node_traits::destroy(node_alloc_, std::addressof(node->value));
+            node_traits::deallocate(node_alloc_, node, 1);
             node = nullptr;
         }
 
 // next_size 函数
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::size_type
-        hashtable<T, Hash, KeyEqual>::next_size(size_type n) const
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::size_type
+        hashtable<T, Hash, KeyEqual, Alloc>::next_size(size_type n) const
         {
             return ht_next_prime(n);
         }
 
 // hash 函数
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::size_type
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::size_type
+        hashtable<T, Hash, KeyEqual, Alloc>::
         hash(const key_type& key, size_type n) const
         {
             return hash_(key) % n;
         }
 
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::size_type
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::size_type
+        hashtable<T, Hash, KeyEqual, Alloc>::
         hash(const key_type& key) const
         {
             return hash_(key) % bucket_size_;
         }
 
 // rehash_if_need 函数
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         rehash_if_need(size_type n)
         {
             if (static_cast<float>(size_ + n) > (float)bucket_size_ * max_load_factor())
@@ -870,9 +971,9 @@ static constexpr size_t ht_prime_list[] = {
 
 // copy_insert
 
-        template <class T, class Hash, class KeyEqual>
+        template <class T, class Hash, class KeyEqual, class Alloc>
         template <class ForwardIter>
-        void hashtable<T, Hash, KeyEqual>::
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         copy_insert_multi(ForwardIter first, ForwardIter last, STL::forward_iterator_tag)
         {
             size_type n = STL::distance(first, last);
@@ -882,9 +983,9 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 
-        template <class T, class Hash, class KeyEqual>
+        template <class T, class Hash, class KeyEqual, class Alloc>
         template <class ForwardIter>
-        void hashtable<T, Hash, KeyEqual>::
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         copy_insert_unique(ForwardIter first, ForwardIter last, STL::forward_iterator_tag)
         {
             size_type n = STL::distance(first, last);
@@ -895,9 +996,9 @@ static constexpr size_t ht_prime_list[] = {
 
 
 // insert_node 函数
-        template <class T, class Hash, class KeyEqual>
-        typename hashtable<T, Hash, KeyEqual>::iterator
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        typename hashtable<T, Hash, KeyEqual, Alloc>::iterator
+        hashtable<T, Hash, KeyEqual, Alloc>::
         insert_node_multi(node_ptr np)
         {
             const auto n = hash(value_traits::get_key(np->value));
@@ -925,9 +1026,9 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // insert_node_unique 函数
-        template <class T, class Hash, class KeyEqual>
-        std::pair<typename hashtable<T, Hash, KeyEqual>::iterator, bool>
-        hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        std::pair<typename hashtable<T, Hash, KeyEqual, Alloc>::iterator, bool>
+        hashtable<T, Hash, KeyEqual, Alloc>::
         insert_node_unique(node_ptr np)
         {
             const auto n = hash(value_traits::get_key(np->value));
@@ -952,18 +1053,19 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // replace_bucket 函数
-        template <class T, class Hash, class KeyEqual>
-        void hashtable<T, Hash, KeyEqual>::
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void hashtable<T, Hash, KeyEqual, Alloc>::
         replace_bucket(size_type bucket_count)
         {
-            bucket_type bucket(bucket_count);
+            bucket_type bucket(bucket_count, nullptr, buckets_.get_allocator());
             if (size_ != 0)
             {
                 for (size_type i = 0; i < bucket_size_; ++i)
                 {
-                    for (auto first = buckets_[i]; first; first = first->next)
-                    {
-                        auto tmp = create_node(first->value);
+                    for (auto first = buckets_[i], next = first; first; first = next)
+                    { // 节点直接挂到新的 bucket 上，不再复制
+                        next = first->next;
+                        auto tmp = first;
                         const auto n = hash(value_traits::get_key(first->value), bucket_count);
                         auto f = bucket[n];
                         bool is_inserted = false;
@@ -990,9 +1092,9 @@ static constexpr size_t ht_prime_list[] = {
         }
 
 // 重载 mystl 的 swap
-        template <class T, class Hash, class KeyEqual>
-        void swap(hashtable<T, Hash, KeyEqual>& lhs,
-                  hashtable<T, Hash, KeyEqual>& rhs) noexcept
+        template <class T, class Hash, class KeyEqual, class Alloc>
+        void swap(hashtable<T, Hash, KeyEqual, Alloc>& lhs,
+                  hashtable<T, Hash, KeyEqual, Alloc>& rhs) noexcept
         {
             lhs.swap(rhs);
         }
@@ -3,6 +3,7 @@
 #define MY_TINY_STL_ITERATOR_H
 
 #include <cstddef>
+#include <type_traits>
 
 namespace STL {
     //五种迭代器类型
@@ -23,11 +24,11 @@ namespace STL {
 
     template <class Iterator>
     struct iterator_traits {
-        typedef typename Iterator::Category    iterator_category;
-        typedef typename Iterator::T           value_type;
-        typedef typename Iterator::Distance    difference_type;
-        typedef typename Iterator::Pointer     pointer;
-        typedef typename Iterator::Reffrence   reference;
+        typedef typename Iterator::iterator_category   iterator_category;
+        typedef typename Iterator::value_type          value_type;
+        typedef typename Iterator::difference_type     difference_type;
+        typedef typename Iterator::pointer             pointer;
+        typedef typename Iterator::reference           reference;
     };
 
     template <class T>
@@ -71,7 +72,7 @@ namespace STL {
     typename iterator_traits<InputIterator>::difference_type
     __distance(InputIterator first, InputIterator last,
                input_iterator_tag) {
-        typename iterator_traits<InputIterator>::difference_typen n = 0;
+        typename iterator_traits<InputIterator>::difference_type n = 0;
         while (first != last) {
             ++ first, ++ n;
         }
@@ -111,9 +112,24 @@ namespace STL {
 
     template <class InputIterator, class Distance>
     void advance (InputIterator &i, Distance n) {
-        return __distance(i, n, iterator_category(i));
+        __advance(i, n, iterator_category(i));
     }
 
+    /*
+     * 分段迭代器协议：底层由若干段连续内存组成的迭代器(如deque_iterator)特化本模板，
+     * 给出所在的段(segment)与段内指针(local)，算法据此对每一段跑不带换段检查的内层循环
+     * 特化需提供：
+     *   is_segmented为std::true_type
+     *   segment_iterator、local_iterator
+     *   segment(it)、local(it)：it所在的段和段内位置
+     *   begin(s)、end(s)：段s的首尾
+     *   compose(s, l)：由段和段内位置合成迭代器，l等于end(s)时落到下一段的开头
+     */
+    template <class Iterator>
+    struct segmented_iterator_traits {
+        typedef std::false_type is_segmented;
+    };
+
 
 
 
@@ -3,6 +3,8 @@
 #include "iterator.h"
 #include "allocator.h"
 #include "construct.h"
+#include <new>
+#include <type_traits>
 
 namespace STL {
 
@@ -32,7 +34,7 @@ namespace STL {
         T& operator *() {
             return node->data;
         }
-        T& operator->() {
+        T* operator->() {
             return &(operator*());
         }
         list_iterator& operator++() {
@@ -56,7 +58,7 @@ namespace STL {
 
     };
 
-    template<class T, class Alloc = allocator<list_node<T>> >
+    template<class T, class Alloc = allocator<T> >
     class list {
     public:
         typedef list_node<T>            list_node;
@@ -66,45 +68,94 @@ namespace STL {
         typedef value_type&             reference;
         typedef size_t                  size_type;
         typedef list_node*              link_type;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<T> allocator_type;
     protected:
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<list_node> list_node_allocator;
+        typedef allocator_traits<list_node_allocator> node_traits;
         link_type node;
-        typedef allocator<list_node> list_node_allocator;
+        list_node_allocator node_alloc; //容器持有的配置器实例
     public:
         //各种构造和析构
         list() {
             empty_initialize();
         }
 
-        explicit list(size_type n, const value_type& val = value_type()) {
+        explicit list(const allocator_type& a) : node_alloc(a) {
+            empty_initialize();
+        }
+
+        explicit list(size_type n, const value_type& val = value_type(),
+                      const allocator_type& a = allocator_type()) : node_alloc(a) {
             empty_initialize();
             for (int i = 0; i < n; ++ i) push_back(val);
         }
 
-        list(list& lis) {
+        list(const list& lis)
+                : node_alloc(node_traits::select_on_container_copy_construction(lis.node_alloc)) {
             empty_initialize();
-            iterator first = lis.begin();
-            iterator last = lis.end();
-            while (first != last) {
-                push_back(*first);
-                first ++;
-            }
+            copy_from(lis);
         }
 
-        list& operator = (const list& rhs) {
+        list(const list& lis, const allocator_type& a) : node_alloc(a) {
             empty_initialize();
-            iterator first = rhs.begin();
-            iterator last = rhs.end();
-            while (first != last) {
-                push_back(*first);
-                first ++;
+            copy_from(lis);
+        }
+
+        //移动构造接管lis的节点，lis换上一个新的空头节点，仍然可用
+        list(list&& lis) : node_alloc(std::move(lis.node_alloc)) {
+            empty_initialize();
+            swap_nodes(lis);
+        }
+
+        list(list&& lis, const allocator_type& a) : node_alloc(a) {
+            empty_initialize();
+            if (node_traits::equal(node_alloc, lis.node_alloc)) swap_nodes(lis);
+            else move_from(lis);
+        }
+
+        list& operator = (const list& rhs) {
+            if (this != &rhs) {
+                clear();
+                if (node_traits::propagate_on_container_copy_assignment::value &&
+                    !node_traits::equal(node_alloc, rhs.node_alloc)) {
+                    //换配置器前，头节点要用原来的配置器释放
+                    node_traits::deallocate(node_alloc, node, 1);
+                    node_alloc = rhs.node_alloc;
+                    empty_initialize();
+                }
+                else STL::__alloc_on_copy(node_alloc, rhs.node_alloc);
+                copy_from(rhs);
             }
+            return *this;
+        }
+
+        /*
+         * propagate_on_container_move_assignment为真或两边配置器相等时直接交换节点，
+         * 原有节点随rhs析构；否则用自己的配置器逐个移动元素
+         */
+        list& operator = (list&& rhs) {
+            if (this != &rhs) {
+                clear();
+                if (node_traits::propagate_on_container_move_assignment::value &&
+                    !node_traits::equal(node_alloc, rhs.node_alloc)) {
+                    node_traits::deallocate(node_alloc, node, 1);
+                    node_alloc = std::move(rhs.node_alloc);
+                    empty_initialize();
+                    swap_nodes(rhs);
+                }
+                else if (node_traits::equal(node_alloc, rhs.node_alloc)) swap_nodes(rhs);
+                else move_from(rhs);
+            }
+            return *this;
         }
 
         ~list() {
             clear();
-            delete_node(node);
+            node_traits::deallocate(node_alloc, node, 1);
         }
 
+        allocator_type get_allocator() const { return allocator_type(node_alloc); }
+
         //元素访问
         reference front() { return *begin(); }
         reference back() { return *(--end()); }
@@ -115,12 +166,26 @@ namespace STL {
         void push_front(const value_type& val) {
             insert(begin(), val);
         }
+        void push_front(value_type&& val) {
+            insert(begin(), std::move(val));
+        }
+        template <class... Args>
+        reference emplace_front(Args&&... args) {
+            return *emplace(begin(), std::forward<Args>(args)...);
+        }
         void pop_front() {
             erase(begin());
         }
         void push_back(const value_type& val) {
             insert(end(), val);
         }
+        void push_back(value_type&& val) {
+            insert(end(), std::move(val));
+        }
+        template <class... Args>
+        reference emplace_back(Args&&... args) {
+            return *emplace(end(), std::forward<Args>(args)...);
+        }
         void pop_back() {
             erase(--end());
         }
@@ -136,7 +201,16 @@ namespace STL {
         }
 
         iterator insert(iterator position, const value_type& val) {
-            link_type tmp = new_node(val);
+            return emplace(position, val);
+        }
+        iterator insert(iterator position, value_type&& val) {
+            return emplace(position, std::move(val));
+        }
+
+        //在position之前用args直接构造一个节点
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args) {
+            link_type tmp = new_node(std::forward<Args>(args)...);
             tmp->nxt = position.node;
             tmp->pre = position.node->pre;
 
@@ -146,9 +220,8 @@ namespace STL {
         }
 
         void swap(list& lis) {
-            link_type tmp = lis.node;
-            lis.node = node;
-            node = tmp;
+            swap_nodes(lis);
+            STL::__alloc_on_swap(node_alloc, lis.node_alloc);
         }
 
         void unique() {
@@ -230,9 +303,12 @@ namespace STL {
 
         void sort() {
             if (size()  <= 1) return ;
-            list<T> carry;
-            list<T> counter[64];
-            int fill = 0;
+            //临时list的哨兵节点也用本list的配置器；counter用到第几个才构造第几个
+            list carry(get_allocator());
+            typename std::aligned_storage<sizeof(list), alignof(list)>::type storage[64];
+            list* counter = reinterpret_cast<list*>(storage);
+            ::new (static_cast<void*>(counter)) list(get_allocator());
+            int fill = 0; //counter[0, fill]已构造
 
             while (!empty()) {
                 carry.splice(carry.begin(), *this, begin());
@@ -242,16 +318,18 @@ namespace STL {
                     carry.swap(counter[i++]);
                 }
                 carry.swap(counter[i]);
-                if (i == fill) ++ fill;
+                if (i == fill && ++ fill < 64) ::new (static_cast<void*>(counter + fill)) list(get_allocator());
             }
             for (int i = 1; i < fill; ++ i)
                 counter[i].merge(counter[i - 1]);
-            swap(counter[fill - 1]);
+            splice(end(), counter[fill - 1]); //不用swap，免得配置器被换成临时list的
+            for (int i = 0; i <= fill && i < 64; ++ i) counter[i].~list();
         }
 
         //容量相关
         void clear() {
-            auto cur = (link_type)node->nxt;
+            //节点的析构与归还都是空操作时(如arena上的平凡元素)直接把链表置空
+            auto cur = node_traits::template trivial_discard<T>::value ? node : (link_type)node->nxt;
             while (cur != node) {
                 link_type tmp = cur;
                 cur = (link_type)cur->nxt;
@@ -273,16 +351,37 @@ namespace STL {
     private:
         //空间配置器相关
 
-        //创建一个有值节点
-        link_type new_node(const T& value) {
-            link_type p = list_node_allocator::allocate();
-            construct(&p->data, value);
+        //创建一个有值节点，args转发给T的构造函数
+        template <class... Args>
+        link_type new_node(Args&&... args) {
+            link_type p = node_traits::allocate(node_alloc, 1);
+            node_traits::construct(node_alloc, &p->data, std::forward<Args>(args)...);
             return p;
         }
         //删除一个有值节点
         void delete_node(link_type p) {
-            destroy(&p->data);
-            list_node_allocator ::deallocate(p);
+            node_traits::destroy(node_alloc, &p->data);
+            node_traits::deallocate(node_alloc, p, 1);
+        }
+
+        void copy_from(const list& lis) {
+            for (auto cur = static_cast<link_type>(lis.node->nxt); cur != lis.node;
+                 cur = static_cast<link_type>(cur->nxt))
+                push_back(cur->data);
+        }
+
+        void move_from(list& lis) {
+            for (auto cur = static_cast<link_type>(lis.node->nxt); cur != lis.node;
+                 cur = static_cast<link_type>(cur->nxt))
+                push_back(std::move(cur->data));
+            lis.clear();
+        }
+
+        //只交换头节点，不动配置器
+        void swap_nodes(list& lis) {
+            link_type tmp = lis.node;
+            lis.node = node;
+            node = tmp;
         }
 
         void print() {
@@ -312,7 +411,7 @@ namespace STL {
         }
 
         void empty_initialize() {   //创建一个空list
-            node = list_node_allocator::allocate();
+            node = node_traits::allocate(node_alloc, 1);
             node->nxt = node;
             node->pre = node;
         }
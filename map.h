@@ -6,7 +6,7 @@
 #include "rb_tree.h"
 #include <algorithm>
 namespace STL {
-    template <class Key, class T, class Compare=less<Key>>
+    template <class Key, class T, class Compare=less<Key>, class Alloc=allocator<std::pair<const Key, T>>>
     class map {
     public:
         typedef Key                     key_type;
@@ -14,7 +14,7 @@ namespace STL {
         typedef std::pair<const Key, T> value_type;
         typedef Compare                 key_compare;
         class value_compare : public binary_function<value_type, value_type, bool> {
-            friend class map<Key, T, Compare> ;
+            friend class map<Key, T, Compare, Alloc> ;
         protected:
             Compare comp;
             value_compare(Compare c) : comp(c) { }
@@ -25,7 +25,7 @@ namespace STL {
         };
 
     private:
-        typedef rb_tree<value_type, key_compare> rep_type;
+        typedef rb_tree<value_type, key_compare, Alloc> rep_type;
         rep_type tree;
 
     public:
@@ -38,12 +38,19 @@ namespace STL {
         typedef typename rep_type::difference_type        difference_type;
         typedef typename rep_type::allocator_type         allocator_type;
         map() = default;
+        explicit map(const key_compare& comp, const allocator_type& a = allocator_type()) : tree(comp, a) {}
+        explicit map(const allocator_type& a) : tree(a) {}
 
         template <class InputIterator>
         map(InputIterator first, InputIterator last):tree(){ tree.insert_unique(first, last); }
-        map(const map& rhs):tree(rhs.tree_){}
+        map(const map& rhs):tree(rhs.tree){}
         map& operator=(const map& rhs) {
-            tree = rhs.tree_;
+            tree = rhs.tree;
+            return *this;
+        }
+        map(map&& rhs) : tree(std::move(rhs.tree)) {}
+        map& operator=(map&& rhs) {
+            tree = std::move(rhs.tree);
             return *this;
         }
 
@@ -115,13 +122,13 @@ namespace STL {
         { return tree.equal_range_unique(key); }
 
         void swap(map& rhs) noexcept
-        { tree.swap(rhs.tree_); }
+        { tree.swap(rhs.tree); }
 
     };
 
 // 重载 mystl 的 swap
-    template <class Key, class Compare>
-    void swap(map<Key, Compare>& lhs, map<Key, Compare>& rhs) noexcept
+    template <class Key, class T, class Compare, class Alloc>
+    void swap(map<Key, T, Compare, Alloc>& lhs, map<Key, T, Compare, Alloc>& rhs) noexcept
     {
         lhs.swap(rhs);
     }
@@ -0,0 +1,295 @@
+#ifndef MY_TINY_STL_MMAP_VECTOR_H
+#define MY_TINY_STL_MMAP_VECTOR_H
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <system_error>
+#include <type_traits>
+#include "algorithm.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace STL {
+#ifndef _WIN32
+    /*
+     * 以文件为底层存储的vector，只适用于可平凡复制的T：文件内容就是元素数组本身，没有文件头
+     * 打开已有文件时直接mmap，不读取也不复制，页面在第一次访问时才由内核换入，可以超过物理内存
+     * 扩容时ftruncate加长文件再mremap(非Linux系统重新mmap)，容量按页取整；
+     * 关闭时把文件截断到size()个元素，下次打开时元素个数由文件大小得出
+     * flush()把修改写回磁盘，不调用时由内核择机写回；read_only模式下映射为只读，修改容器的操作抛出异常，
+     * 通过迭代器写入元素会触发段错误
+     * 迭代器就是T*，STL::sort等算法可以直接作用在映射上
+     */
+    template <class T>
+    class mmap_vector {
+        static_assert(std::is_trivially_copyable<T>::value, "mmap_vector requires a trivially copyable T");
+    public:
+        typedef T           value_type;
+        typedef T*          pointer;
+        typedef T*          iterator;
+        typedef const T*    const_iterator;
+        typedef T&          reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+
+        enum open_mode { read_write, read_only };
+
+    private:
+        int fd;
+        T* base;
+        size_type len; //元素个数
+        size_type cap; //映射并且文件中已有空间的元素个数
+        size_type mapped; //映射的字节数，扩容后是页大小的倍数
+        bool writable;
+
+        //把文件和映射扩充到至少n个元素
+        void grow_to(size_type n);
+        void check_writable() const;
+        static size_type page_size() { return size_type(sysconf(_SC_PAGESIZE)); }
+        static void fail(const char* what) { throw std::system_error(errno, std::generic_category(), what); }
+
+    public:
+        mmap_vector() : fd(-1), base(nullptr), len(0), cap(0), mapped(0), writable(false) {}
+        //打开path，read_write模式下文件不存在时创建
+        explicit mmap_vector(const char* path, open_mode mode = read_write);
+        mmap_vector(const mmap_vector&) = delete;
+        mmap_vector& operator=(const mmap_vector&) = delete;
+        mmap_vector(mmap_vector&& v) noexcept;
+        mmap_vector& operator=(mmap_vector&& v) noexcept;
+        ~mmap_vector() { close(); }
+
+        void open(const char* path, open_mode mode = read_write);
+        //解除映射，可写时把文件截断到size()个元素后关闭
+        void close();
+        bool is_open() const { return fd >= 0; }
+        bool is_read_only() const { return !writable; }
+        //把修改写回文件，async为真时只发起写回不等待
+        void flush(bool async = false);
+
+        //迭代器相关
+        iterator begin() { return base; }
+        iterator end() { return base + len; }
+        const_iterator begin() const { return base; }
+        const_iterator end() const { return base + len; }
+
+        //容量相关
+        size_type size() const { return len; }
+        size_type capacity() const { return cap; }
+        bool empty() const { return len == 0; }
+        void reserve(size_type n);
+        //新增的元素全部为0字节
+        void resize(size_type n);
+        //把文件和映射缩小到size()个元素(按页取整)
+        void shrink_yo_fit();
+
+        //元素访问
+        reference front() { return *base; }
+        reference back() { return *(base + len - 1); }
+        reference operator[](size_type n) { return *(base + n); }
+        const T& operator[](size_type n) const { return *(base + n); }
+        pointer data() { return base; }
+
+        //元素调整
+        void push_back(const value_type& val);
+        template <class... Args>
+        reference emplace_back(Args&&... args);
+        void pop_back();
+        iterator erase(iterator position);
+        iterator erase(iterator first, iterator last);
+        void clear();
+    };
+
+    template<class T>
+    mmap_vector<T>::mmap_vector(const char *path, open_mode mode)
+            : fd(-1), base(nullptr), len(0), cap(0), mapped(0), writable(false) {
+        open(path, mode);
+    }
+
+    template<class T>
+    mmap_vector<T>::mmap_vector(mmap_vector &&v) noexcept
+            : fd(v.fd), base(v.base), len(v.len), cap(v.cap), mapped(v.mapped), writable(v.writable) {
+        v.fd = -1;
+        v.base = nullptr;
+        v.len = v.cap = v.mapped = 0;
+    }
+
+    template<class T>
+    mmap_vector<T>& mmap_vector<T>::operator=(mmap_vector &&v) noexcept {
+        if (this != &v) {
+            close();
+            STL::swap(fd, v.fd);
+            STL::swap(base, v.base);
+            STL::swap(len, v.len);
+            STL::swap(cap, v.cap);
+            STL::swap(mapped, v.mapped);
+            STL::swap(writable, v.writable);
+        }
+        return *this;
+    }
+
+    template<class T>
+    void mmap_vector<T>::open(const char *path, open_mode mode) {
+        close();
+        writable = mode == read_write;
+        int new_fd = ::open(path, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (new_fd < 0) fail("mmap_vector: open");
+        struct stat st;
+        if (fstat(new_fd, &st) != 0) {
+            int err = errno;
+            ::close(new_fd);
+            errno = err;
+            fail("mmap_vector: fstat");
+        }
+        size_type bytes = size_type(st.st_size);
+        if (bytes % sizeof(T) != 0) {
+            ::close(new_fd);
+            errno = EINVAL;
+            fail("mmap_vector: file size is not a multiple of sizeof(T)");
+        }
+        if (bytes != 0) {
+            void* p = mmap(nullptr, bytes, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, new_fd, 0);
+            if (p == MAP_FAILED) {
+                int err = errno;
+                ::close(new_fd);
+                errno = err;
+                fail("mmap_vector: mmap");
+            }
+            base = static_cast<T*>(p);
+        }
+        fd = new_fd;
+        len = cap = bytes / sizeof(T);
+        mapped = bytes;
+    }
+
+    template<class T>
+    void mmap_vector<T>::close() {
+        if (fd < 0) return;
+        if (base != nullptr) munmap(base, mapped);
+        //容量多出的部分不留在文件里，析构路径上失败也无从报告
+        if (writable && ftruncate(fd, off_t(len * sizeof(T))) != 0) {}
+        ::close(fd);
+        fd = -1;
+        base = nullptr;
+        len = cap = mapped = 0;
+    }
+
+    template<class T>
+    void mmap_vector<T>::flush(bool async) {
+        if (base != nullptr && writable && msync(base, mapped, async ? MS_ASYNC : MS_SYNC) != 0)
+            fail("mmap_vector: msync");
+    }
+
+    template<class T>
+    void mmap_vector<T>::check_writable() const {
+        if (!writable) {
+            errno = fd < 0 ? EBADF : EROFS;
+            fail("mmap_vector: not open for writing");
+        }
+    }
+
+    template<class T>
+    void mmap_vector<T>::grow_to(size_type n) {
+        check_writable();
+        const size_type page = page_size();
+        const size_type new_bytes = (n * sizeof(T) + page - 1) / page * page;
+        if (ftruncate(fd, off_t(new_bytes)) != 0) fail("mmap_vector: ftruncate");
+        void* p;
+        if (base == nullptr) {
+            p = mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        else {
+#ifdef __linux__
+            p = mremap(base, mapped, new_bytes, MREMAP_MAYMOVE);
+#else
+            munmap(base, mapped);
+            base = nullptr;
+            mapped = 0;
+            p = mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+#endif
+        }
+        if (p == MAP_FAILED) fail("mmap_vector: mremap");
+        base = static_cast<T*>(p);
+        mapped = new_bytes;
+        cap = new_bytes / sizeof(T);
+    }
+
+    template<class T>
+    void mmap_vector<T>::reserve(size_type n) {
+        if (n > cap) grow_to(n);
+    }
+
+    template<class T>
+    void mmap_vector<T>::resize(size_type n) {
+        check_writable();
+        if (n > cap) grow_to(n);
+        //ftruncate加长的部分本来就是0，但截短后再加长时旧内容还在映射中
+        if (n > len) memset(static_cast<void*>(base + len), 0, (n - len) * sizeof(T));
+        len = n;
+    }
+
+    template<class T>
+    void mmap_vector<T>::shrink_yo_fit() {
+        check_writable();
+        if (base == nullptr) return;
+        const size_type page = page_size();
+        const size_type new_bytes = (len * sizeof(T) + page - 1) / page * page;
+        if (new_bytes >= mapped) return;
+        munmap(reinterpret_cast<char*>(base) + new_bytes, mapped - new_bytes);
+        if (new_bytes == 0) base = nullptr;
+        mapped = new_bytes;
+        cap = new_bytes / sizeof(T);
+        if (ftruncate(fd, off_t(new_bytes)) != 0) fail("mmap_vector: ftruncate");
+    }
+
+    template<class T>
+    void mmap_vector<T>::push_back(const value_type &val) {
+        if (len == cap) {
+            T x_copy = val; //val可能引用映射中的元素，mremap后失效
+            grow_to(cap == 0 ? 1 : cap * 2);
+            base[len ++] = x_copy;
+            return;
+        }
+        check_writable();
+        base[len ++] = val;
+    }
+
+    template<class T>
+    template<class... Args>
+    typename mmap_vector<T>::reference mmap_vector<T>::emplace_back(Args&&... args) {
+        T x(std::forward<Args>(args)...);
+        push_back(x);
+        return back();
+    }
+
+    template<class T>
+    void mmap_vector<T>::pop_back() {
+        check_writable();
+        -- len;
+    }
+
+    template<class T>
+    typename mmap_vector<T>::iterator mmap_vector<T>::erase(iterator position) {
+        return erase(position, position + 1);
+    }
+
+    template<class T>
+    typename mmap_vector<T>::iterator mmap_vector<T>::erase(iterator first, iterator last) {
+        check_writable();
+        STL::copy(last, end(), first);
+        len -= last - first;
+        return first;
+    }
+
+    template<class T>
+    void mmap_vector<T>::clear() {
+        check_writable();
+        len = 0;
+    }
+#endif
+}
+
+#endif //MY_TINY_STL_MMAP_VECTOR_H
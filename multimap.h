@@ -6,7 +6,7 @@
 #include "rb_tree.h"
 
 namespace STL {
-    template <class Key, class T, class Compare=less<Key>>
+    template <class Key, class T, class Compare=less<Key>, class Alloc=allocator<std::pair<const Key, T>>>
     class multimap {
     public:
         typedef Key                     key_type;
@@ -14,7 +14,7 @@ namespace STL {
         typedef std::pair<const Key, T> value_type;
         typedef Compare                 key_compare;
         class value_compare : public binary_function<value_type, value_type, bool> {
-            friend class multimap<Key, T, Compare> ;
+            friend class multimap<Key, T, Compare, Alloc> ;
         protected:
             Compare comp;
             value_compare(Compare c) : comp(c) { }
@@ -25,7 +25,7 @@ namespace STL {
         };
 
     private:
-        typedef rb_tree<value_type, key_compare> rep_type;
+        typedef rb_tree<value_type, key_compare, Alloc> rep_type;
         rep_type tree;
 
     public:
@@ -38,12 +38,19 @@ namespace STL {
         typedef typename rep_type::difference_type        difference_type;
         typedef typename rep_type::allocator_type         allocator_type;
         multimap() = default;
+        explicit multimap(const key_compare& comp, const allocator_type& a = allocator_type()) : tree(comp, a) {}
+        explicit multimap(const allocator_type& a) : tree(a) {}
 
         template <class InputIterator>
         multimap(InputIterator first, InputIterator last):tree(){ tree.insert_multi(first, last); }
-        multimap(const multimap& rhs):tree(rhs.tree_){}
+        multimap(const multimap& rhs):tree(rhs.tree){}
         multimap& operator=(const multimap& rhs) {
-            tree = rhs.tree_;
+            tree = rhs.tree;
+            return *this;
+        }
+        multimap(multimap&& rhs) : tree(std::move(rhs.tree)) {}
+        multimap& operator=(multimap&& rhs) {
+            tree = std::move(rhs.tree);
             return *this;
         }
 
@@ -112,13 +119,13 @@ namespace STL {
         { return tree.equal_range_multi(key); }
 
         void swap(multimap& rhs) noexcept
-        { tree.swap(rhs.tree_); }
+        { tree.swap(rhs.tree); }
 
     };
 
 // 重载 mystl 的 swap
-    template <class Key, class Compare>
-    void swap(multimap<Key, Compare>& lhs, multimap<Key, Compare>& rhs) noexcept
+    template <class Key, class T, class Compare, class Alloc>
+    void swap(multimap<Key, T, Compare, Alloc>& lhs, multimap<Key, T, Compare, Alloc>& rhs) noexcept
     {
         lhs.swap(rhs);
     }
@@ -9,7 +9,7 @@
 #include "rb_tree.h"
 
 namespace STL {
-    template <class Key, class Compare=less<Key>>
+    template <class Key, class Compare=less<Key>, class Alloc=allocator<Key>>
     class multiset {
     public:
         typedef Key         key_type;
@@ -22,7 +22,7 @@ namespace STL {
         struct identity : public unary_function<T, T> {
             const T& operator()(const T& x) const { return x; }
         };
-        typedef rb_tree<value_type,  key_compare> rep_type;
+        typedef rb_tree<value_type, key_compare, Alloc> rep_type;
         rep_type tree;
 
     public:
@@ -35,12 +35,19 @@ namespace STL {
         typedef typename rep_type::difference_type        difference_type;
         typedef typename rep_type::allocator_type         allocator_type;
         multiset() = default;
+        explicit multiset(const key_compare& comp, const allocator_type& a = allocator_type()) : tree(comp, a) {}
+        explicit multiset(const allocator_type& a) : tree(a) {}
 
         template <class InputIterator>
         multiset(InputIterator first, InputIterator last):tree(){ tree.insert_multi(first, last); }
-        multiset(const multiset& rhs): tree(rhs.tree_){}
+        multiset(const multiset& rhs): tree(rhs.tree){}
         multiset& operator=(const multiset& rhs) {
-            tree = rhs.tree_;
+            tree = rhs.tree;
+            return *this;
+        }
+        multiset(multiset&& rhs) : tree(std::move(rhs.tree)) {}
+        multiset& operator=(multiset&& rhs) {
+            tree = std::move(rhs.tree);
             return *this;
         }
 
@@ -116,16 +123,16 @@ namespace STL {
         { return tree.equal_range_multi(key); }
 
         void swap(multiset& rhs) noexcept
-        { tree.swap(rhs.tree_); }
+        { tree.swap(rhs.tree); }
 
     public:
-        friend bool operator==(const multiset& lhs, const multiset& rhs) { return lhs.tree_ == rhs.tree_; }
-        friend bool operator< (const multiset& lhs, const multiset& rhs) { return lhs.tree_ < rhs.tree_; }
+        friend bool operator==(const multiset& lhs, const multiset& rhs) { return lhs.tree == rhs.tree; }
+        friend bool operator< (const multiset& lhs, const multiset& rhs) { return lhs.tree < rhs.tree; }
     };
 
 // 重载 mystl 的 swap
-    template <class Key, class Compare>
-    void swap(multiset<Key, Compare>& lhs, multiset<Key, Compare>& rhs) noexcept
+    template <class Key, class Compare, class Alloc>
+    void swap(multiset<Key, Compare, Alloc>& lhs, multiset<Key, Compare, Alloc>& rhs) noexcept
     {
         lhs.swap(rhs);
     }
@@ -26,6 +26,15 @@ namespace STL {
             push_heap(c.begin(), c.end(), comp);
 
         }
+        void push(value_type&& x) {
+            c.push_back(std::move(x));
+            push_heap(c.begin(), c.end(), comp);
+        }
+        template <class... Args>
+        void emplace(Args&&... args) {
+            c.emplace_back(std::forward<Args>(args)...);
+            push_heap(c.begin(), c.end(), comp);
+        }
         void pop() {
             pop_heap(c.begin(), c.end(), comp);
 
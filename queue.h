@@ -12,11 +12,18 @@ namespace STL {
     protected:
         Sequence c;
     public:
+        queue() {}
+        //用现成的容器初始化，例如指定了容量和溢出策略的circular_buffer
+        explicit queue(const Sequence& s) : c(s) {}
+        explicit queue(Sequence&& s) : c(std::move(s)) {}
         bool empty() {return c.empty();}
         size_type size() { return c.size();}
         reference_type front() {return c.front();}
         reference_type back() {return c.back();}
         void push(const value_type & val) { c.push_back(val);}
+        void push(value_type && val) { c.push_back(std::move(val));}
+        template <class... Args>
+        void emplace(Args&&... args) { c.emplace_back(std::forward<Args>(args)...);}
         void pop() { c.pop_front();}
     };
 }
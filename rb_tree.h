@@ -628,8 +628,8 @@ namespace STL {
             return y;
         }
 
-// 模板类 rb_tree（数据类型，比较类型）
-        template <class T, class Compare>
+// 模板类 rb_tree（数据类型，比较类型，空间配置器）
+        template <class T, class Compare, class Alloc = allocator<T>>
         class rb_tree {
         public:
             using tree_traits = rb_tree_traits<T>;
@@ -644,10 +644,12 @@ namespace STL {
             using value_type = typename tree_traits::value_type;
             using key_compare = Compare;
 
-            using allocator_type = allocator<T>;
-            using data_allocator = allocator<T>;
-            using base_allocator = allocator<base_type>;
-            using node_allocator = allocator<node_type>;
+            using allocator_type = typename allocator_traits<Alloc>::template rebind_alloc<T>;
+            using data_allocator = allocator_type;
+            using base_allocator = typename allocator_traits<Alloc>::template rebind_alloc<base_type>;
+            using node_allocator = typename allocator_traits<Alloc>::template rebind_alloc<node_type>;
+            using base_traits = allocator_traits<base_allocator>;
+            using node_traits = allocator_traits<node_allocator>;
 
             using pointer = typename allocator_type::pointer;
             using const_pointer = typename allocator_type::const_pointer;
@@ -660,7 +662,7 @@ namespace STL {
             using const_iterator = rb_tree_const_iterator<T>;
 
             allocator_type get_allocator() const {
-                return m_node_alloc;
+                return allocator_type(m_node_alloc);
             }
             key_compare key_comp() const {
                 return m_key_comp;
@@ -671,10 +673,8 @@ namespace STL {
             base_ptr m_header;      // 特殊节点，与根节点互为对方的父节点
             size_type m_node_count; // 节点数
             key_compare m_key_comp; // 节点键值比较的准则
-            allocator_type m_alloc; // 四种类型的分配器
-            data_allocator m_data_alloc;
+            node_allocator m_node_alloc; // 容器持有的配置器实例，分别用于数据节点和 header
             base_allocator m_base_alloc;
-            node_allocator m_node_alloc;
 
         private:
             // 以下三个函数用于取得根节点，最小节点和最大节点
@@ -694,51 +694,78 @@ namespace STL {
                 rb_tree_init();
             }
 
-            rb_tree(const rb_tree &rhs) {
+            explicit rb_tree(const key_compare &comp, const allocator_type &a = allocator_type())
+                    : m_key_comp(comp), m_node_alloc(a), m_base_alloc(a) {
                 rb_tree_init();
-                if (rhs.m_node_count != 0) {
-                    root() = copy_from(rhs.root(), m_header);
-                    leftmost() = rb_tree_min(root());
-                    rightmost() = rb_tree_max(root());
-                }
-                m_node_count = rhs.m_node_count;
-                m_key_comp = rhs.m_key_comp;
             }
 
-            rb_tree(rb_tree &&rhs) noexcept
-                    : m_header(std::move(rhs.m_header)), m_node_count(rhs.m_node_count),
-                      m_key_comp(rhs.m_key_comp) {
-                rhs.reset();
+            explicit rb_tree(const allocator_type &a)
+                    : m_node_alloc(a), m_base_alloc(a) {
+                rb_tree_init();
+            }
+
+            rb_tree(const rb_tree &rhs)
+                    : rb_tree(rhs, node_traits::select_on_container_copy_construction(rhs.m_node_alloc)) {}
+
+            rb_tree(const rb_tree &rhs, const allocator_type &a)
+                    : m_key_comp(rhs.m_key_comp), m_node_alloc(a), m_base_alloc(a) {
+                rb_tree_init();
+                copy_tree(rhs);
+            }
+
+            // rhs 留下一个新的空 header，移动后仍可继续使用
+            rb_tree(rb_tree &&rhs)
+                    : m_header(rhs.m_header), m_node_count(rhs.m_node_count),
+                      m_key_comp(rhs.m_key_comp), m_node_alloc(rhs.m_node_alloc),
+                      m_base_alloc(rhs.m_base_alloc) {
+                rhs.rb_tree_init();
             }
 
             rb_tree &operator=(const rb_tree &rhs) {
                 if (this != &rhs) {
                     clear();
-
-                    if (rhs.m_node_count != 0) {
-                        root() = copy_from(rhs.root(), m_header);
-                        leftmost() = rb_tree_min(root());
-                        rightmost() = rb_tree_max(root());
+                    if (node_traits::propagate_on_container_copy_assignment::value &&
+                        !node_traits::equal(m_node_alloc, rhs.m_node_alloc)) {
+                        // header 要用原来的配置器释放
+                        base_traits::deallocate(m_base_alloc, m_header, 1);
+                        m_node_alloc = rhs.m_node_alloc;
+                        m_base_alloc = rhs.m_base_alloc;
+                        rb_tree_init();
                     }
-
-                    m_node_count = rhs.m_node_count;
+                    else {
+                        STL::__alloc_on_copy(m_node_alloc, rhs.m_node_alloc);
+                        STL::__alloc_on_copy(m_base_alloc, rhs.m_base_alloc);
+                    }
+                    copy_tree(rhs);
                     m_key_comp = rhs.m_key_comp;
                 }
                 return *this;
             }
             rb_tree &operator=(rb_tree &&rhs) {
-                clear();
-                m_header = std::move(rhs.m_header);
-                m_node_count = rhs.m_node_count;
-                m_key_comp = rhs.m_key_comp;
-                rhs.reset();
+                if (this == &rhs) return *this;
+                if (node_traits::propagate_on_container_move_assignment::value ||
+                    node_traits::equal(m_node_alloc, rhs.m_node_alloc)) {
+                    // 可以直接接管 rhs 的节点，自己原来的节点和 header 先用原来的配置器释放
+                    clear();
+                    base_traits::deallocate(m_base_alloc, m_header, 1);
+                    m_header = rhs.m_header;
+                    m_node_count = rhs.m_node_count;
+                    m_key_comp = rhs.m_key_comp;
+                    rhs.rb_tree_init();
+                    STL::__alloc_on_move(m_node_alloc, rhs.m_node_alloc);
+                    STL::__alloc_on_move(m_base_alloc, rhs.m_base_alloc);
+                }
+                else { // 配置器不同又不随移动转移，只能把元素逐个移动到自己的节点中
+                    clear();
+                    m_key_comp = rhs.m_key_comp;
+                    move_tree(rhs);
+                }
                 return *this;
             }
 
             ~rb_tree() {
                 clear();
-                m_base_alloc.destroy(m_header);
-                m_base_alloc.deallocate(m_header, 1);
+                base_traits::deallocate(m_base_alloc, m_header, 1);
             }
 
         public:
@@ -946,7 +973,9 @@ namespace STL {
             // 递归清空
             void clear() {
                 if (m_node_count != 0) {
-                    erase_since(root());
+                    //节点的析构与归还都是空操作时(如arena上的平凡元素)不必遍历整棵树
+                    if (!node_traits::template trivial_discard<value_type>::value)
+                        erase_since(root());
                     leftmost() = m_header;
                     root() = nullptr;
                     rightmost() = m_header;
@@ -1062,6 +1091,8 @@ namespace STL {
                     STL::swap(m_header, rhs.m_header);
                     STL::swap(m_node_count, rhs.m_node_count);
                     STL::swap(m_key_comp, rhs.m_key_comp);
+                    STL::__alloc_on_swap(m_node_alloc, rhs.m_node_alloc);
+                    STL::__alloc_on_swap(m_base_alloc, rhs.m_base_alloc);
                 }
             }
 
@@ -1069,14 +1100,14 @@ namespace STL {
             //初始化
             template <class... Args>
             node_ptr create_node(Args &&...args) {
-                auto tmp = m_node_alloc.allocate(1);
+                auto tmp = node_traits::allocate(m_node_alloc, 1);
                 try {
-                    m_data_alloc.construct(std::addressof(tmp->value), std::forward<Args>(args)...);
+                    node_traits::construct(m_node_alloc, std::addressof(tmp->value), std::forward<Args>(args)...);
                     tmp->left = nullptr;
                     tmp->right = nullptr;
                     tmp->parent = nullptr;
                 } catch (...) {
-                    m_node_alloc.destroy(tmp);
+                    node_traits::deallocate(m_node_alloc, tmp, 1);
                     throw;
                 }
                 return tmp;
@@ -1089,13 +1120,21 @@ namespace STL {
                 return tmp;
             }
             void destroy_node(node_ptr p) {
-                m_data_alloc.destroy(&p->value);
-                m_node_alloc.destroy(p);
-                m_node_alloc.deallocate(p, 1);
+                node_traits::destroy(m_node_alloc, &p->value);
+                node_traits::deallocate(m_node_alloc, p, 1);
+            }
+            // 把 rhs 的节点复制到当前的空树中
+            void copy_tree(const rb_tree &rhs) {
+                if (rhs.m_node_count != 0) {
+                    root() = copy_from(rhs.root(), m_header);
+                    leftmost() = rb_tree_min(root());
+                    rightmost() = rb_tree_max(root());
+                }
+                m_node_count = rhs.m_node_count;
             }
 
             void rb_tree_init() {
-                m_header = m_base_alloc.allocate(1);
+                m_header = base_traits::allocate(m_base_alloc, 1);
                 m_header->color = rb_tree_red; // header_ 节点颜色为红，与 root 区分
                 root() = nullptr;
                 leftmost() = m_header;
@@ -1103,9 +1142,11 @@ namespace STL {
                 m_node_count = 0;
             }
 
-            void reset() {
-                m_header = nullptr;
-                m_node_count = 0;
+            // 按中序把 rhs 的元素移动到当前的空树中，rhs 随后清空
+            void move_tree(rb_tree &rhs) {
+                for (iterator it = rhs.begin(); it != rhs.end(); ++ it)
+                    emplace_multi_use_hint(end(), std::move(it.node->get_node_ptr()->value));
+                rhs.clear();
             }
 
             // 插入结点
@@ -1118,7 +1159,7 @@ namespace STL {
                     add_to_left = m_key_comp(key, value_traits::get_key(x->get_node_ptr()->value));
                     x = add_to_left ? x->left : x->right;
                 }
-                return make_pair(y, add_to_left);
+                return std::make_pair(y, add_to_left);
             }
 
             std::pair<std::pair<base_ptr, bool>, bool> get_insert_unique_pos(const key_type &key) {
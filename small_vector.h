@@ -0,0 +1,424 @@
+#ifndef MY_TINY_STL_SMALL_VECTOR_H
+#define MY_TINY_STL_SMALL_VECTOR_H
+#include "allocator.h"
+#include "iterator.h"
+#include "uninitialized.h"
+#include "algorithm.h"
+#include <type_traits>
+namespace STL {
+    /*
+     * 带内联缓冲区的vector：前N个元素放在对象内部，不分配内存，超过N个时整体搬到配置器分配的空间上
+     * 接口与vector相同；元素在内联缓冲区时移动和交换需要逐个搬运元素，迭代器随之失效
+     * 搬运使用uninitialized_relocate，可按字节搬移的类型整段memmove
+     */
+    template <class T, size_t N, class Alloc = allocator<T>>
+    class small_vector {
+    public:
+        typedef T           value_type;
+        typedef value_type* pointer;
+        typedef value_type* iterator;
+        typedef value_type& reference;
+        typedef size_t      size_type;
+        typedef ptrdiff_t   difference_type;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<T> allocator_type;
+
+        enum{ inline_capacity = N };
+
+    private:
+        typedef allocator_type data_allocator;
+        typedef allocator_traits<data_allocator> alloc_traits;
+        iterator start;
+        iterator finish;
+        iterator mem_end;
+        data_allocator data_alloc; //容器持有的配置器实例
+        typename std::aligned_storage<sizeof(T) * (N == 0 ? 1 : N), alignof(T)>::type buffer; //内联缓冲区
+
+        iterator inline_begin() { return reinterpret_cast<iterator>(&buffer); }
+        void reset_inline() { start = finish = inline_begin(); mem_end = start + N; }
+        //在position处用args构造一个元素，空间不足时扩容
+        template <class... Args>
+        void emplace_aux(iterator position, Args&&... args);
+        //析构所有元素并释放分配的空间，之后回到内联缓冲区
+        void deallocate();
+        //把元素搬到容量为len的新空间，len不小于size()
+        void grow_to(const size_type& len);
+        //接管v的元素：v在堆上且steal为真时直接接管空间，否则逐个搬到自己的空间，v变为空
+        void take(small_vector& v, bool steal);
+
+    public:
+        //构造函数，复制构造函数，析构函数
+        small_vector() : data_alloc() { reset_inline(); }
+        explicit small_vector(const allocator_type& a) : data_alloc(a) { reset_inline(); }
+        small_vector(const size_type& n, const value_type& value, const allocator_type& a = allocator_type());
+        explicit small_vector(const size_type& n);
+        small_vector(const small_vector& v);
+        small_vector(small_vector&& v);
+        ~small_vector();
+        small_vector& operator =(const small_vector& v);
+        small_vector& operator =(small_vector&& v);
+
+        allocator_type get_allocator() const { return data_alloc; }
+        //元素是否还在内联缓冲区中
+        bool is_inline() const { return start == reinterpret_cast<const T*>(&buffer); }
+
+        //操作符重载
+        bool operator ==(small_vector& v);
+        bool operator !=(small_vector& v);
+
+        //迭代器相关
+        iterator begin() { return start; }
+        iterator end() { return finish; }
+
+        //容量相关
+        size_type size() { return finish - start; }
+        size_type capacity() { return mem_end - start; }
+        bool empty() { return start == finish; }
+        void resize(const size_t& n, value_type value=value_type());
+        void resize_default_init(const size_t& n);
+        void reserve(const size_t& n);
+        //元素不超过N个时搬回内联缓冲区并释放分配的空间
+        void shrink_yo_fit();
+
+        //元素访问
+        reference front() { return *start; }
+        reference back() { return *(finish - 1); }
+        reference operator[](const size_type& n) { return *(start + n); }
+        pointer data() { return start; }
+
+        //元素调整
+        void push_back(const value_type& val);
+        void push_back(value_type&& val);
+        template <class... Args>
+        reference emplace_back(Args&&... args);
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args);
+        void pop_back();
+        iterator erase(iterator position);
+        iterator erase(iterator first, iterator last);
+        void insert(iterator position, const size_type& n, const value_type& val);
+        iterator insert(iterator position, const value_type& value);
+        iterator insert(iterator position, value_type&& value);
+        void clear();
+        void swap(small_vector& rhs);
+        void assign(size_type n, const value_type& value);
+    };
+
+    //构造，析构，赋值
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const size_type &n, const value_type &value, const allocator_type& a)
+            : data_alloc(a) {
+        reset_inline();
+        reserve(n);
+        finish = STL::uninitialized_fill_n(start, n, value);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const size_type &n) {
+        reset_inline();
+        reserve(n);
+        finish = STL::uninitialized_value_construct_n(start, n);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(const small_vector &v)
+            : data_alloc(alloc_traits::select_on_container_copy_construction(v.data_alloc)) {
+        reset_inline();
+        reserve(v.finish - v.start);
+        finish = STL::uninitialized_copy(v.start, v.finish, start);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::small_vector(small_vector &&v) : data_alloc(std::move(v.data_alloc)) {
+        reset_inline();
+        take(v, true);
+    }
+
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>::~small_vector() {
+        deallocate();
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::deallocate() {
+        alloc_traits::destroy(data_alloc, start, finish);
+        if (!is_inline()) alloc_traits::deallocate(data_alloc, start, capacity());
+        reset_inline();
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::take(small_vector &v, bool steal) {
+        if (steal && !v.is_inline()) {
+            start = v.start;
+            finish = v.finish;
+            mem_end = v.mem_end;
+            v.reset_inline();
+            return;
+        }
+        reserve(v.finish - v.start);
+        finish = STL::uninitialized_relocate(v.start, v.finish, start);
+        v.finish = v.start;
+    }
+
+    //按propagate_on_container_copy_assignment决定用谁的配置器，换配置器前先用旧的释放空间
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(const small_vector &v) {
+        if (this != &v) {
+            if (alloc_traits::propagate_on_container_copy_assignment::value &&
+                !alloc_traits::equal(data_alloc, v.data_alloc)) {
+                deallocate();
+                STL::__alloc_on_copy(data_alloc, v.data_alloc);
+            }
+            clear();
+            reserve(v.finish - v.start);
+            finish = STL::uninitialized_copy(v.start, v.finish, start);
+        }
+        return *this;
+    }
+
+    /*
+     * v在堆上且propagate_on_container_move_assignment为真或两边配置器相等时直接接管v的空间，
+     * 否则把v的元素逐个搬到自己的空间；propagate_on_container_move_assignment为真时，
+     * 即使v在内联缓冲区中也换成v的配置器，换之前先用旧的释放自己的空间
+     */
+    template<class T, size_t N, class Alloc>
+    small_vector<T, N, Alloc>& small_vector<T, N, Alloc>::operator=(small_vector &&v) {
+        if (this != &v) {
+            const bool steal = alloc_traits::propagate_on_container_move_assignment::value ||
+                               alloc_traits::equal(data_alloc, v.data_alloc);
+            if (alloc_traits::propagate_on_container_move_assignment::value || (steal && !v.is_inline())) {
+                deallocate();
+                STL::__alloc_on_move(data_alloc, v.data_alloc);
+            }
+            else clear();
+            take(v, steal);
+        }
+        return *this;
+    }
+
+    //两边都可能在内联缓冲区中，借助一个临时对象搬运三次
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::swap(small_vector &rhs) {
+        if (this != &rhs) {
+            small_vector tmp(std::move(rhs));
+            rhs = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    template<class T, size_t N, class Alloc>
+    bool small_vector<T, N, Alloc>::operator==(small_vector &v) {
+        if (v.size() != size()) return false;
+        auto p1 = begin();
+        auto p2 = v.begin();
+        for (; p1 != finish; ++ p1, ++ p2)
+            if (*p1 != *p2) return false;
+        return true;
+    }
+
+    template<class T, size_t N, class Alloc>
+    bool small_vector<T, N, Alloc>::operator!=(small_vector &v) {
+        return (*this == v) == false;
+    }
+
+    //容量相关
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::grow_to(const size_type &len) {
+        const size_type old_size = size();
+        if (!is_inline() && is_trivially_relocatable<T>::value) { //已在堆上，交给配置器reallocate，可能原地增长
+            start = alloc_traits::reallocate(data_alloc, start, capacity(), len);
+        }
+        else {
+            iterator new_start = alloc_traits::allocate(data_alloc, len);
+            STL::uninitialized_relocate(start, finish, new_start);
+            if (!is_inline()) alloc_traits::deallocate(data_alloc, start, capacity());
+            start = new_start;
+        }
+        finish = start + old_size;
+        mem_end = start + len;
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::reserve(const size_t &n) {
+        if (n > capacity()) grow_to(n);
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::shrink_yo_fit() {
+        if (is_inline() || finish == mem_end) return;
+        const size_type n = size();
+        iterator new_start = n <= N ? inline_begin() : alloc_traits::allocate(data_alloc, n);
+        STL::uninitialized_relocate(start, finish, new_start);
+        alloc_traits::deallocate(data_alloc, start, capacity());
+        start = new_start;
+        finish = new_start + n;
+        mem_end = n <= N ? new_start + N : finish;
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::resize(const size_t &n, value_type value) {
+        if (n < size()) {
+            alloc_traits::destroy(data_alloc, start + n, finish);
+            finish = start + n;
+            return;
+        }
+        reserve(n);
+        finish = STL::uninitialized_fill_n(finish, n - size(), value);
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::resize_default_init(const size_t &n) {
+        if (n < size()) {
+            alloc_traits::destroy(data_alloc, start + n, finish);
+            finish = start + n;
+            return;
+        }
+        reserve(n);
+        finish = STL::uninitialized_default_construct_n(finish, n - size());
+    }
+
+    //元素调整
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::push_back(const value_type &val) {
+        if (finish != mem_end) {
+            alloc_traits::construct(data_alloc, finish, val);
+            ++ finish;
+        }
+        else {
+            emplace_aux(finish, val);
+        }
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::push_back(value_type &&val) {
+        emplace_back(std::move(val));
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class... Args>
+    typename small_vector<T, N, Alloc>::reference small_vector<T, N, Alloc>::emplace_back(Args&&... args) {
+        if (finish != mem_end) {
+            alloc_traits::construct(data_alloc, finish, std::forward<Args>(args)...);
+            ++ finish;
+        }
+        else {
+            emplace_aux(finish, std::forward<Args>(args)...);
+        }
+        return *(finish - 1);
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class... Args>
+    typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::emplace(iterator position, Args&&... args) {
+        auto delta = position - start;
+        emplace_aux(position, std::forward<Args>(args)...);
+        return start + delta;
+    }
+
+    template<class T, size_t N, class Alloc>
+    template<class... Args>
+    void small_vector<T, N, Alloc>::emplace_aux(iterator position, Args&&... args) {
+        if (finish != mem_end && position == finish) { //在尾部插入，直接构造
+            alloc_traits::construct(data_alloc, finish, std::forward<Args>(args)...);
+            ++ finish;
+        }
+        else if (finish != mem_end && is_trivially_relocatable<T>::value) { //仍有备用空间，整段后移一格
+            T x_copy(std::forward<Args>(args)...); //args可能引用容器中的元素，先构造出来再搬动
+            memmove(static_cast<void*>(position + 1), static_cast<void*>(position), (finish - position) * sizeof(T));
+            ++ finish;
+            alloc_traits::construct(data_alloc, position, std::move(x_copy));
+        }
+        else if (finish != mem_end) {    //仍有备用空间
+            T x_copy(std::forward<Args>(args)...);
+            alloc_traits::construct(data_alloc, finish, std::move(*(finish-1)));
+            ++ finish;
+            STL::move_backward(position, finish - 2, finish - 1);
+            *position = std::move(x_copy);
+        }
+        else { //无备用空间，容量翻倍后再插入
+            const size_type old_size = size();
+            const size_type index = position - start;
+            T x_copy(std::forward<Args>(args)...); //args可能引用容器中的元素
+            grow_to(old_size == 0 ? 1 : old_size * 2);
+            emplace_aux(start + index, std::move(x_copy));
+        }
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::pop_back() {
+        -- finish;
+        alloc_traits::destroy(data_alloc, finish);
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::clear() {
+        erase(begin(), end());
+    }
+
+    template<class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::erase(iterator position) {
+        return erase(position, position + 1);
+    }
+
+    template<class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::erase(iterator first, iterator last) {
+        if (is_trivially_relocatable<T>::value) {
+            alloc_traits::destroy(data_alloc, first, last);
+            memmove(static_cast<void*>(first), static_cast<void*>(last), (finish - last) * sizeof(T));
+            finish = finish - (last - first);
+            return first;
+        }
+        iterator i = STL::move(last, finish, first);
+        alloc_traits::destroy(data_alloc, i, finish);
+        finish = i;
+        return first;
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::insert(iterator position, const size_type &n, const value_type &val) {
+        if (n == 0) return;
+        if (size_type(mem_end - finish) < n) { //空间不足，先扩容再插入，val可能引用容器中的元素
+            const size_type old_size = size();
+            const size_type index = position - start;
+            T x_copy = val;
+            grow_to(old_size + STL::max(old_size, n));
+            insert(start + index, n, x_copy);
+            return;
+        }
+        T x_copy = val;
+        const size_type ele_num = finish - position; //插入点之后的元素个数
+        iterator old_finish = finish;
+        if (ele_num > n) {
+            STL::uninitialized_move(finish - n, finish, finish);
+            finish += n;
+            STL::move_backward(position, old_finish - n, old_finish);
+            STL::fill(position, position + n, x_copy);
+        }
+        else {
+            STL::uninitialized_fill_n(finish, n - ele_num, x_copy);
+            finish += n - ele_num;
+            STL::uninitialized_move(position, old_finish, finish);
+            finish += ele_num;
+            STL::fill(position, old_finish, x_copy);
+        }
+    }
+
+    template<class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::insert(iterator position, const value_type &value) {
+        return emplace(position, value);
+    }
+
+    template<class T, size_t N, class Alloc>
+    typename small_vector<T, N, Alloc>::iterator small_vector<T, N, Alloc>::insert(iterator position, value_type &&value) {
+        return emplace(position, std::move(value));
+    }
+
+    template<class T, size_t N, class Alloc>
+    void small_vector<T, N, Alloc>::assign(size_type n, const value_type &value) {
+        T x_copy = value; //value可能引用容器中的元素
+        clear();
+        reserve(n);
+        finish = STL::uninitialized_fill_n(start, n, x_copy);
+    }
+}
+
+#endif //MY_TINY_STL_SMALL_VECTOR_H
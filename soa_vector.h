@@ -0,0 +1,327 @@
+#ifndef MY_TINY_STL_SOA_VECTOR_H
+#define MY_TINY_STL_SOA_VECTOR_H
+#include "allocator.h"
+#include "iterator.h"
+#include "uninitialized.h"
+#include "algorithm.h"
+#include <tuple>
+#include <type_traits>
+namespace STL {
+    //编译期下标序列，用来同时展开各列
+    template <size_t... I>
+    struct __index_seq {};
+    template <size_t N, size_t... I>
+    struct __make_index_seq : __make_index_seq<N - 1, N - 1, I...> {};
+    template <size_t... I>
+    struct __make_index_seq<0, I...> {
+        typedef __index_seq<I...> type;
+    };
+
+    //一列连续元素的视图，不拥有内存，可直接交给按数组处理的循环或SIMD内核
+    template <class T>
+    struct column_span {
+        T* ptr;
+        size_t len;
+
+        T* data() const { return ptr; }
+        size_t size() const { return len; }
+        T* begin() const { return ptr; }
+        T* end() const { return ptr + len; }
+        T& operator[](size_t i) const { return ptr[i]; }
+    };
+
+    /*
+     * 按列存储的vector：每个字段单独存放在一段按缓存行(64字节)对齐的连续数组中，
+     * 只访问一两个字段的循环不会把其余字段读进缓存，column<I>()给出第I列的连续视图
+     * 行访问返回std::tuple<Fields&...>作为代理引用，用std::get<I>读写，也可以整行赋值
+     * 各列由aligned_allocator<F, 64>分配，扩容时按列用uninitialized_relocate搬移
+     */
+    template <class... Fields>
+    class soa_vector {
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+    public:
+        typedef std::tuple<Fields...>   value_type;
+        typedef std::tuple<Fields&...>  reference;
+        typedef size_t                  size_type;
+        typedef ptrdiff_t               difference_type;
+
+        enum{ column_alignment = 64 };
+
+        template <size_t I>
+        using column_type = typename std::tuple_element<I, value_type>::type;
+        template <class F>
+        using column_allocator = aligned_allocator<F, column_alignment>;
+
+        //按行下标遍历的随机访问迭代器，解引用得到代理引用
+        struct iterator : public STL::iterator<random_access_iterator_tag, value_type, ptrdiff_t, void, reference> {
+            soa_vector* v;
+            size_type i;
+
+            iterator(soa_vector* vec = nullptr, size_type idx = 0) : v(vec), i(idx) {}
+            reference operator*() const { return (*v)[i]; }
+            reference operator[](difference_type n) const { return (*v)[i + n]; }
+            iterator& operator++() { ++ i; return *this; }
+            iterator operator++(int) { iterator tmp = *this; ++ i; return tmp; }
+            iterator& operator--() { -- i; return *this; }
+            iterator operator--(int) { iterator tmp = *this; -- i; return tmp; }
+            iterator& operator+=(difference_type n) { i += n; return *this; }
+            iterator& operator-=(difference_type n) { i -= n; return *this; }
+            iterator operator+(difference_type n) const { return iterator(v, i + n); }
+            iterator operator-(difference_type n) const { return iterator(v, i - n); }
+            difference_type operator-(const iterator& x) const { return difference_type(i) - difference_type(x.i); }
+            bool operator==(const iterator& x) const { return i == x.i; }
+            bool operator!=(const iterator& x) const { return i != x.i; }
+            bool operator<(const iterator& x) const { return i < x.i; }
+        };
+
+    private:
+        typedef typename __make_index_seq<sizeof...(Fields)>::type indices;
+        std::tuple<Fields*...> columns;
+        size_type len;
+        size_type cap;
+
+        template <size_t I>
+        column_type<I>* col() const { return std::get<I>(columns); }
+
+        template <size_t... I>
+        reference row(size_type n, __index_seq<I...>) { return reference(col<I>()[n]...); }
+
+        //把每列搬到容量为n的新数组
+        template <size_t... I>
+        void grow_to(size_type n, __index_seq<I...>);
+        template <size_t I>
+        void grow_column(size_type n);
+        //无备用空间时追加一行：每列先在新数组里构造新元素，再搬旧元素，参数引用本容器的元素也安全
+        template <size_t... I, class... Args>
+        void realloc_append(size_type n, __index_seq<I...>, Args&&... args);
+        template <size_t I, class Arg>
+        void realloc_append_column(size_type n, Arg&& arg);
+        template <size_t... I, class... Args>
+        void construct_row(size_type n, __index_seq<I...>, Args&&... args);
+        template <size_t... I>
+        void push_tuple(const value_type& r, __index_seq<I...>);
+        template <size_t... I>
+        void copy_from(const soa_vector& v, __index_seq<I...>);
+        template <size_t... I>
+        void erase_rows(size_type first, size_type last, __index_seq<I...>);
+        template <size_t... I>
+        void value_construct(size_type first, size_type last, __index_seq<I...>);
+        template <size_t... I>
+        void deallocate(__index_seq<I...>);
+
+    public:
+        soa_vector() : len(0), cap(0) {}
+        soa_vector(const soa_vector& v);
+        soa_vector(soa_vector&& v) noexcept;
+        ~soa_vector() { deallocate(indices()); }
+        soa_vector& operator=(const soa_vector& v);
+        soa_vector& operator=(soa_vector&& v) noexcept;
+        void swap(soa_vector& rhs) noexcept;
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, len); }
+
+        size_type size() const { return len; }
+        size_type capacity() const { return cap; }
+        bool empty() const { return len == 0; }
+        void reserve(size_type n);
+        //新增的行每个字段都值初始化
+        void resize(size_type n);
+
+        reference operator[](size_type n) { return row(n, indices()); }
+        reference front() { return (*this)[0]; }
+        reference back() { return (*this)[len - 1]; }
+        //第I列的连续视图，扩容后失效
+        template <size_t I>
+        column_span<column_type<I>> column() { return column_span<column_type<I>>{col<I>(), len}; }
+        template <size_t I>
+        column_type<I>* data() { return col<I>(); }
+
+        //按字段顺序给出一行的值
+        template <class... Args>
+        void emplace_back(Args&&... args);
+        void push_back(const Fields&... fields) { emplace_back(fields...); }
+        void push_back(const value_type& row);
+        void pop_back();
+        iterator erase(iterator position);
+        iterator erase(iterator first, iterator last);
+        void clear();
+    };
+
+    template<class... Fields>
+    template<size_t I>
+    void soa_vector<Fields...>::grow_column(size_type n) {
+        typedef column_type<I> F;
+        F* old = col<I>();
+        F* p = column_allocator<F>::allocate(n);
+        STL::uninitialized_relocate(old, old + len, p);
+        column_allocator<F>::deallocate(old, cap);
+        std::get<I>(columns) = p;
+    }
+
+    template<class... Fields>
+    template<size_t... I>
+    void soa_vector<Fields...>::grow_to(size_type n, __index_seq<I...>) {
+        int expand[] = {0, (grow_column<I>(n), 0)...};
+        (void)expand;
+        cap = n;
+    }
+
+    template<class... Fields>
+    template<size_t I, class Arg>
+    void soa_vector<Fields...>::realloc_append_column(size_type n, Arg&& arg) {
+        typedef column_type<I> F;
+        F* old = col<I>();
+        F* p = column_allocator<F>::allocate(n);
+        STL::construct(p + len, std::forward<Arg>(arg));
+        STL::uninitialized_relocate(old, old + len, p);
+        column_allocator<F>::deallocate(old, cap);
+        std::get<I>(columns) = p;
+    }
+
+    template<class... Fields>
+    template<size_t... I, class... Args>
+    void soa_vector<Fields...>::realloc_append(size_type n, __index_seq<I...>, Args&&... args) {
+        int expand[] = {0, (realloc_append_column<I>(n, std::forward<Args>(args)), 0)...};
+        (void)expand;
+        cap = n;
+    }
+
+    template<class... Fields>
+    template<size_t... I, class... Args>
+    void soa_vector<Fields...>::construct_row(size_type n, __index_seq<I...>, Args&&... args) {
+        int expand[] = {0, (STL::construct(col<I>() + n, std::forward<Args>(args)), 0)...};
+        (void)expand;
+    }
+
+    template<class... Fields>
+    template<size_t... I>
+    void soa_vector<Fields...>::copy_from(const soa_vector& v, __index_seq<I...>) {
+        int expand[] = {0, (std::get<I>(columns) = column_allocator<column_type<I>>::allocate(v.len),
+                            STL::uninitialized_copy(v.col<I>(), v.col<I>() + v.len, col<I>()), 0)...};
+        (void)expand;
+        len = cap = v.len;
+    }
+
+    template<class... Fields>
+    template<size_t... I>
+    void soa_vector<Fields...>::erase_rows(size_type first, size_type last, __index_seq<I...>) {
+        int expand[] = {0, (STL::destroy(STL::move(col<I>() + last, col<I>() + len, col<I>() + first),
+                                         col<I>() + len), 0)...};
+        (void)expand;
+        len -= last - first;
+    }
+
+    template<class... Fields>
+    template<size_t... I>
+    void soa_vector<Fields...>::value_construct(size_type first, size_type last, __index_seq<I...>) {
+        int expand[] = {0, (STL::uninitialized_value_construct(col<I>() + first, col<I>() + last), 0)...};
+        (void)expand;
+    }
+
+    template<class... Fields>
+    template<size_t... I>
+    void soa_vector<Fields...>::deallocate(__index_seq<I...>) {
+        int expand[] = {0, (STL::destroy(col<I>(), col<I>() + len),
+                            column_allocator<column_type<I>>::deallocate(col<I>(), cap), 0)...};
+        (void)expand;
+        columns = std::tuple<Fields*...>();
+        len = cap = 0;
+    }
+
+    template<class... Fields>
+    soa_vector<Fields...>::soa_vector(const soa_vector& v) : len(0), cap(0) {
+        if (v.len != 0) copy_from(v, indices());
+    }
+
+    template<class... Fields>
+    soa_vector<Fields...>::soa_vector(soa_vector&& v) noexcept : columns(v.columns), len(v.len), cap(v.cap) {
+        v.columns = std::tuple<Fields*...>();
+        v.len = v.cap = 0;
+    }
+
+    template<class... Fields>
+    soa_vector<Fields...>& soa_vector<Fields...>::operator=(const soa_vector& v) {
+        if (this != &v) {
+            soa_vector tmp(v);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    template<class... Fields>
+    soa_vector<Fields...>& soa_vector<Fields...>::operator=(soa_vector&& v) noexcept {
+        if (this != &v) {
+            deallocate(indices());
+            swap(v);
+        }
+        return *this;
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::swap(soa_vector& rhs) noexcept {
+        std::swap(columns, rhs.columns);
+        STL::swap(len, rhs.len);
+        STL::swap(cap, rhs.cap);
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::reserve(size_type n) {
+        if (n > cap) grow_to(n, indices());
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::resize(size_type n) {
+        if (n < len) {
+            erase(begin() + n, end());
+            return;
+        }
+        reserve(n);
+        value_construct(len, n, indices());
+        len = n;
+    }
+
+    template<class... Fields>
+    template<class... Args>
+    void soa_vector<Fields...>::emplace_back(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+        if (len == cap) realloc_append(cap == 0 ? 8 : cap * 2, indices(), std::forward<Args>(args)...);
+        else construct_row(len, indices(), std::forward<Args>(args)...);
+        ++ len;
+    }
+
+    template<class... Fields>
+    template<size_t... I>
+    void soa_vector<Fields...>::push_tuple(const value_type& r, __index_seq<I...>) {
+        emplace_back(std::get<I>(r)...);
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::push_back(const value_type& row) {
+        push_tuple(row, indices());
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::pop_back() {
+        erase_rows(len - 1, len, indices());
+    }
+
+    template<class... Fields>
+    typename soa_vector<Fields...>::iterator soa_vector<Fields...>::erase(iterator position) {
+        erase_rows(position.i, position.i + 1, indices());
+        return position;
+    }
+
+    template<class... Fields>
+    typename soa_vector<Fields...>::iterator soa_vector<Fields...>::erase(iterator first, iterator last) {
+        if (first != last) erase_rows(first.i, last.i, indices());
+        return first;
+    }
+
+    template<class... Fields>
+    void soa_vector<Fields...>::clear() {
+        erase_rows(0, len, indices());
+    }
+}
+
+#endif //MY_TINY_STL_SOA_VECTOR_H
@@ -4,6 +4,7 @@
 
 #include "algorithm.h"
 #include <algorithm>
+#include <type_traits>
 namespace STL {
 
     struct __true_type {};
@@ -11,228 +12,40 @@ namespace STL {
 
 
 
-    template<class type>
-    struct __type_traits {
-        typedef __false_type has_trivial_default_constructor;
-        typedef __false_type has_trivial_copy_constructor;
-        typedef __false_type has_trivial_assignment_constructor;
-        typedef __false_type has_trivial_destructor;
-        typedef __false_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<bool> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-
-        typedef __true_type is_POD_type;
-    };
-    template<>
-    struct __type_traits<wchar_t> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-
-        typedef __true_type is_POD_type;
-    };
-    template<>
-    struct __type_traits<long long> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-
-        typedef __true_type is_POD_type;
-    };
-    template<>
-    struct __type_traits<unsigned long long> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-
-        typedef __true_type is_POD_type;
-    };
-
-    template<>
-    struct __type_traits<char> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-    };
-    template<>
-    struct __type_traits<unsigned char> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<signed char> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<short> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<unsigned short> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<int> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-    };
-    template<>
-    struct __type_traits<unsigned int> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
+    template<bool B>
+    struct __bool_type {
+        typedef __false_type type;
     };
     template<>
-    struct __type_traits<long> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<unsigned long> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-    };
-    template<>
-    struct __type_traits<float> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<double> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<long double> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
+    struct __bool_type<true> {
+        typedef __true_type type;
     };
 
+    /*
+     * 由编译器给出的std::is_trivially_*判断，不再需要为每种内置类型手写特化，
+     * 用户定义的平凡类型、指针和浮点数也能走快速路径
+     * is_POD_type表示复制构造和复制赋值都是平凡的，uninitialized_*据此决定是否把构造换成赋值/memmove；
+     * 只看可平凡复制不够，如含const成员的类型复制赋值被删除，只能原地构造
+     */
+    template<class type>
+    struct __type_traits {
+        typedef typename __bool_type<std::is_trivially_default_constructible<type>::value>::type has_trivial_default_constructor;
+        typedef typename __bool_type<std::is_trivially_copy_constructible<type>::value>::type has_trivial_copy_constructor;
+        typedef typename __bool_type<std::is_trivially_copy_assignable<type>::value>::type has_trivial_assignment_constructor;
+        typedef typename __bool_type<std::is_trivially_destructible<type>::value>::type has_trivial_destructor;
+        typedef typename __bool_type<std::is_trivially_copy_constructible<type>::value &&
+                                     std::is_trivially_copy_assignable<type>::value>::type is_POD_type;
+    };
+
+    /*
+     * 能否按字节搬到新地址(memcpy过去、原处不再析构)来代替“移动构造+析构”
+     * 可平凡复制的类型总是可以；只持有指针的句柄类(如独占指针的包装)虽然不可平凡复制，
+     * 但对象里没有指向自身的指针，也可以，这时特化为true_type选择加入：
+     *     template<> struct STL::is_trivially_relocatable<my_handle> : std::true_type {};
+     * vector扩容、插入删除时的搬移据此换成realloc/memmove
+     */
     template<class T>
-    struct __type_traits<T *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-    };
-    template<class T>
-    struct __type_traits<const T *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-    };
-    template<>
-    struct __type_traits<char *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<unsigned char *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<signed char *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<const char *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<const signed char *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
-    template<>
-    struct __type_traits<const unsigned char *> {
-        typedef __true_type has_trivial_default_constructor;
-        typedef __true_type has_trivial_copy_constructor;
-        typedef __true_type has_trivial_assignment_constructor;
-        typedef __true_type has_trivial_destructor;
-        typedef __true_type is_POD_type;
-
-    };
+    struct is_trivially_relocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
 
     template <class T, T v>
     struct integral_constant {
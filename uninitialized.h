@@ -3,6 +3,8 @@
 #include "type_traits.h"
 #include "construct.h"
 #include "algorithm.h"
+#include <cstring>
+#include <type_traits>
 
 namespace STL {
     /*********************  uninitialized_fill_n() *********************/
@@ -11,7 +13,7 @@ namespace STL {
                                                const Size& n,
                                                const T& x,
                                                __true_type) {
-        return std::fill_n(first, n, x); ///交由高阶函数去实现
+        return STL::fill_n(first, n, x); ///交由高阶函数去实现，分段迭代器逐段填充
     }
 
     template<class ForwardIterator, class Size, class T>
@@ -47,7 +49,7 @@ namespace STL {
                                              InputIterator last,
                                              ForwardIterator result,
                                              __true_type) {
-        return copy(first, last, result); ///交由高阶函数去实现
+        return STL::copy(first, last, result); ///交由高阶函数去实现，指针区间会变成memmove
     }
 
     template<class ForwardIterator, class InputIterator>
@@ -60,7 +62,7 @@ namespace STL {
         return result;
     }
     template<class ForwardIterator, class InputIterator, class T>
-    ForwardIterator __uninitialized_copy(ForwardIterator first,
+    ForwardIterator __uninitialized_copy(InputIterator first,
                                          InputIterator last,
                                          ForwardIterator result,
                                          T*) {
@@ -76,6 +78,162 @@ namespace STL {
 
 
 
+    /*********************  uninitialized_move() *********************/
+    /*
+     * 把[first, last)移动构造到未初始化的result处，源区间的元素仍然存在(处于被移走的状态)，由调用者析构
+     * POD类型移动即复制，交给STL::move，指针区间会变成memmove
+     */
+    template<class ForwardIterator, class InputIterator>
+    ForwardIterator __uninitialized_move_aux(InputIterator first,
+                                             InputIterator last,
+                                             ForwardIterator result,
+                                             __true_type) {
+        return STL::move(first, last, result);
+    }
+
+    template<class ForwardIterator, class InputIterator>
+    ForwardIterator __uninitialized_move_aux(InputIterator first,
+                                             InputIterator last,
+                                             ForwardIterator result,
+                                             __false_type) {
+        for ( ; first != last; ++ first, ++ result)
+            construct(& *result, std::move(*first));
+        return result;
+    }
+
+    template<class ForwardIterator, class InputIterator, class T>
+    ForwardIterator __uninitialized_move(InputIterator first,
+                                         InputIterator last,
+                                         ForwardIterator result,
+                                         T*) {
+        typedef typename STL::__type_traits<T>::is_POD_type is_POD;
+        return __uninitialized_move_aux(first, last, result, is_POD());
+    }
+
+    template<class ForwardIterator, class InputIterator>
+    ForwardIterator uninitialized_move(InputIterator first,
+                                       InputIterator last,
+                                       ForwardIterator result) {
+        return __uninitialized_move(first, last, result, value_type(result));
+    }
+
+    //移动n个元素，返回源和目的区间各自的下一个位置
+    template<class InputIterator, class Size, class ForwardIterator>
+    pair<InputIterator, ForwardIterator> uninitialized_move_n(InputIterator first,
+                                                              Size n,
+                                                              ForwardIterator result) {
+        for ( ; n > 0; -- n, ++ first, ++ result)
+            construct(& *result, std::move(*first));
+        return pair<InputIterator, ForwardIterator>(first, result);
+    }
+
+
+
+    /*********************  uninitialized_default_construct() *********************/
+    /*
+     * 默认初始化：可平凡默认构造的类型什么也不做，内存里原来是什么就是什么，
+     * 适合马上会被整体覆盖的大缓冲区；其余类型逐个调用默认构造函数
+     */
+    template<class ForwardIterator, class T>
+    ForwardIterator __uninitialized_default_construct_n(ForwardIterator first, size_t n, T*) {
+        if (std::is_trivially_default_constructible<T>::value) {
+            STL::advance(first, n);
+            return first;
+        }
+        for ( ; n > 0; -- n, ++ first)
+            ::new (static_cast<void*>(& *first)) T;
+        return first;
+    }
+
+    template<class ForwardIterator, class Size>
+    ForwardIterator uninitialized_default_construct_n(ForwardIterator first, Size n) {
+        return __uninitialized_default_construct_n(first, n, value_type(first));
+    }
+
+    template<class ForwardIterator>
+    void uninitialized_default_construct(ForwardIterator first, ForwardIterator last) {
+        __uninitialized_default_construct_n(first, STL::distance(first, last), value_type(first));
+    }
+
+
+
+    /*********************  uninitialized_value_construct() *********************/
+    /*
+     * 值初始化：平凡类型置零(填入T()，指针区间编译器会变成memset)，其余类型逐个调用T()
+     */
+    template<class ForwardIterator, class T>
+    ForwardIterator __uninitialized_value_construct_aux(ForwardIterator first, size_t n, T*, std::true_type) {
+        return STL::fill_n(first, n, T());
+    }
+
+    template<class ForwardIterator, class T>
+    ForwardIterator __uninitialized_value_construct_aux(ForwardIterator first, size_t n, T*, std::false_type) {
+        for ( ; n > 0; -- n, ++ first)
+            construct(& *first);
+        return first;
+    }
+
+    template<class ForwardIterator, class T>
+    ForwardIterator __uninitialized_value_construct_n(ForwardIterator first, size_t n, T* p) {
+        return __uninitialized_value_construct_aux(first, n, p, std::is_trivial<T>());
+    }
+
+    template<class ForwardIterator, class Size>
+    ForwardIterator uninitialized_value_construct_n(ForwardIterator first, Size n) {
+        return __uninitialized_value_construct_n(first, n, value_type(first));
+    }
+
+    template<class ForwardIterator>
+    void uninitialized_value_construct(ForwardIterator first, ForwardIterator last) {
+        __uninitialized_value_construct_n(first, STL::distance(first, last), value_type(first));
+    }
+
+
+
+
+    /*
+     * 把[first, last)逐个搬到未初始化的result处：移动构造不会抛异常(或元素不能复制)时移动，否则复制
+     * 用于容器扩容时搬运旧元素，源区间随后由调用者析构
+     */
+    template<class InputIterator, class ForwardIterator>
+    ForwardIterator __uninitialized_move_if_noexcept(InputIterator first,
+                                                     InputIterator last,
+                                                     ForwardIterator result) {
+        for ( ; first != last; ++ first, ++ result)
+            construct(& *result, std::move_if_noexcept(*first));
+        return result;
+    }
+
+
+
+    /*********************  uninitialized_relocate() *********************/
+    /*
+     * 把[first, last)搬到未初始化的result处，源区间元素的生命周期随之结束，调用者不再析构它们
+     * is_trivially_relocatable的类型整段memmove，其余逐个移动构造(移动可能抛异常时复制)再析构源元素
+     */
+    template<class T>
+    T* __uninitialized_relocate_aux(T* first, T* last, T* result, std::true_type) {
+        const size_t n = last - first;
+        if (n != 0) memmove(static_cast<void*>(result), static_cast<const void*>(first), n * sizeof(T));
+        return result + n;
+    }
+
+    template<class T>
+    T* __uninitialized_relocate_aux(T* first, T* last, T* result, std::false_type) {
+        for ( ; first != last; ++ first, ++ result) {
+            construct(result, std::move_if_noexcept(*first));
+            STL::destroy(first);
+        }
+        return result;
+    }
+
+    template<class T>
+    T* uninitialized_relocate(T* first, T* last, T* result) {
+        return __uninitialized_relocate_aux(first, last, result,
+                std::integral_constant<bool, is_trivially_relocatable<T>::value>());
+    }
+
+
 
     /*********************  uninitialized_fill() *********************/
     template<class ForwardIterator, class T>
@@ -83,7 +241,7 @@ namespace STL {
                                   ForwardIterator last,
                                   const T& x,
                                   __true_type) {
-        fill(first, last, x); ///交由高阶函数去实现
+        STL::fill(first, last, x); ///交由高阶函数去实现
     }
 
     template<class ForwardIterator, class T>
@@ -5,11 +5,12 @@
 
 namespace STL {
 
-    template<class Key, class T, class Hash = STL::hash <Key>, class KeyEqual = STL::equal_to <Key>>
+    template<class Key, class T, class Hash = STL::hash <Key>, class KeyEqual = STL::equal_to <Key>,
+            class Alloc = STL::allocator<std::pair<const Key, T>>>
     class unordered_map {
     private:
         // 使用 hashtable 作为底层机制
-        typedef hashtable<std::pair<const Key, T>, Hash, KeyEqual> base_type;
+        typedef hashtable<std::pair<const Key, T>, Hash, KeyEqual, Alloc> base_type;
         base_type ht_;
 
     public:
@@ -40,10 +41,15 @@ namespace STL {
                 : ht_(100, Hash(), KeyEqual()) {
         }
 
+        explicit unordered_map(const allocator_type &a)
+                : ht_(100, Hash(), KeyEqual(), a) {
+        }
+
         explicit unordered_map(size_type bucket_count,
                                const Hash &hash = Hash(),
-                               const KeyEqual &equal = KeyEqual())
-                : ht_(bucket_count, hash, equal) {
+                               const KeyEqual &equal = KeyEqual(),
+                               const allocator_type &a = allocator_type())
+                : ht_(bucket_count, hash, equal, a) {
         }
 
         template<class InputIterator>
@@ -76,6 +82,15 @@ namespace STL {
         }
 
 
+        unordered_map(unordered_map&& rhs)
+                : ht_(std::move(rhs.ht_)) {
+        }
+
+        unordered_map& operator=(unordered_map&& rhs) {
+            ht_ = std::move(rhs.ht_);
+            return *this;
+        }
+
         ~unordered_map() = default;
 
         // 迭代器相关
@@ -150,9 +165,9 @@ namespace STL {
 
 
 // 重载 mystl 的 swap
-    template<class Key, class T, class Hash, class KeyEqual>
-    void swap(unordered_map<Key, T, Hash, KeyEqual> &lhs,
-              unordered_map<Key, T, Hash, KeyEqual> &rhs) {
+    template<class Key, class T, class Hash, class KeyEqual, class Alloc>
+    void swap(unordered_map<Key, T, Hash, KeyEqual, Alloc> &lhs,
+              unordered_map<Key, T, Hash, KeyEqual, Alloc> &rhs) {
         lhs.swap(rhs);
     }
 }
@@ -6,12 +6,13 @@
 
 namespace STL {
 
-    template <class Key, class Hash = STL::hash<Key>, class KeyEqual = STL::equal_to<Key>>
+    template <class Key, class Hash = STL::hash<Key>, class KeyEqual = STL::equal_to<Key>,
+            class Alloc = STL::allocator<Key>>
     class unordered_set
     {
     private:
         // 使用 hashtable 作为底层机制
-        typedef hashtable<Key, Hash, KeyEqual> base_type;
+        typedef hashtable<Key, Hash, KeyEqual, Alloc> base_type;
         base_type ht_;
 
     public:
@@ -39,10 +40,16 @@ namespace STL {
         {
         }
 
+        explicit unordered_set(const allocator_type& a)
+                :ht_(100, Hash(), KeyEqual(), a)
+        {
+        }
+
         explicit unordered_set(size_type bucket_count,
                                const Hash& hash = Hash(),
-                               const KeyEqual& equal = KeyEqual())
-                :ht_(bucket_count, hash, equal)
+                               const KeyEqual& equal = KeyEqual(),
+                               const allocator_type& a = allocator_type())
+                :ht_(bucket_count, hash, equal, a)
         {
         }
 
@@ -78,6 +85,15 @@ namespace STL {
             return *this;
         }
 
+        unordered_set(unordered_set&& rhs)
+                : ht_(std::move(rhs.ht_)) {
+        }
+
+        unordered_set& operator=(unordered_set&& rhs) {
+            ht_ = std::move(rhs.ht_);
+            return *this;
+        }
+
         ~unordered_set() = default;
 
         // 迭代器相关
@@ -154,8 +170,8 @@ namespace STL {
 
 // 重载 mystl 的 swap
     template <class Key, class Hash, class KeyEqual, class Alloc>
-    void swap(unordered_set<Key, Hash, KeyEqual>& lhs,
-              unordered_set<Key, Hash, KeyEqual>& rhs)
+    void swap(unordered_set<Key, Hash, KeyEqual, Alloc>& lhs,
+              unordered_set<Key, Hash, KeyEqual, Alloc>& rhs)
     {
         lhs.swap(rhs);
     }
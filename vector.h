@@ -4,8 +4,36 @@
 #include "iterator.h"
 #include "uninitialized.h"
 #include "algorithm.h"
+#include <type_traits>
 namespace STL {
-    template <class T, class Alloc = allocator<T>>
+    /*
+     * vector的扩容策略：容量不足时由grow(capacity, need)给出新容量，结果不小于need
+     * round_to_usable为真时再按配置器实际交付的区块大小上调(见allocator_traits::usable_size)，
+     * 区块里本来就多出来的零头直接算进容量，reserve/resize也按此上调
+     */
+    struct vector_growth_double { //每次翻倍，从1开始
+        enum{ round_to_usable = 0 };
+        static size_t grow(size_t capacity, size_t need) {
+            size_t len = capacity == 0 ? 1 : capacity * 2;
+            return len < need ? need : len;
+        }
+    };
+
+    struct vector_growth_golden { //每次增长一半，大容量时浪费的空间更少，旧区块也更可能被后续请求复用
+        enum{ round_to_usable = 0 };
+        static size_t grow(size_t capacity, size_t need) {
+            size_t len = capacity < 2 ? capacity + 1 : capacity + capacity / 2;
+            return len < need ? need : len;
+        }
+    };
+
+    //在Base的基础上按区块大小上调
+    template <class Base = vector_growth_double>
+    struct vector_growth_size_class : Base {
+        enum{ round_to_usable = 1 };
+    };
+
+    template <class T, class Alloc = allocator<T>, class Growth = vector_growth_size_class<>>
     class vector {
     public:
         typedef T           value_type;
@@ -14,21 +42,59 @@ namespace STL {
         typedef value_type& reference;
         typedef size_t      size_type;
         typedef ptrdiff_t   ptrdiff_t;
+        typedef typename allocator_traits<Alloc>::template rebind_alloc<T> allocator_type;
 
     private:
+        typedef allocator_type data_allocator;
+        typedef allocator_traits<data_allocator> alloc_traits;
         iterator start;
         iterator finish;
         iterator mem_end;
-        typedef Alloc data_allocator;
-        void insert_aux(iterator position, const T& x);
+        data_allocator data_alloc; //容器持有的配置器实例
+        //在position处用args构造一个元素，空间不足时扩容
+        template <class... Args>
+        void emplace_aux(iterator position, Args&&... args);
         void deallocate();
         void fill_initialize(const size_type &n, const T& value) ;
         iterator allocate_and_fill(const size_type& n, const T& x);
+        //按扩容策略把len上调到配置器实际交付的容量
+        size_type round_capacity(const size_type& len) {
+            return Growth::round_to_usable ? alloc_traits::usable_size(data_alloc, len) : len;
+        }
+        //至少要容纳need个元素时的新容量
+        size_type next_capacity(const size_type& need) {
+            return round_capacity(Growth::grow(capacity(), need));
+        }
+        //把容量扩充到len(按round_capacity上调)，可按字节搬移(is_trivially_relocatable)的元素交给配置器reallocate，可能原地增长而不必复制
+        void grow_to(size_type len);
+        void grow_to(const size_type& len, std::true_type);
+        void grow_to(const size_type& len, std::false_type);
+        /*
+         * 区间构造、插入、赋值按迭代器种类分派：前向迭代器先求出个数，只分配一次，
+         * 可平凡复制的元素经uninitialized_copy/STL::copy在指针区间上变成memmove；
+         * 输入迭代器只能走一遍，逐个插入
+         */
+        template <class InputIterator>
+        void range_init(InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        void range_init(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+        template <class InputIterator>
+        void range_insert(iterator position, InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        void range_insert(iterator position, ForwardIterator first, ForwardIterator last, forward_iterator_tag);
+        template <class InputIterator>
+        void append_aux(InputIterator first, InputIterator last, input_iterator_tag);
+        template <class RandomAccessIterator>
+        void append_aux(RandomAccessIterator first, RandomAccessIterator last, random_access_iterator_tag);
+        template <class InputIterator>
+        void range_assign(InputIterator first, InputIterator last, input_iterator_tag);
+        template <class ForwardIterator>
+        void range_assign(ForwardIterator first, ForwardIterator last, forward_iterator_tag);
         void fill_assign(size_type n, const value_type& value)
         {
             if (n > capacity())
             {
-                vector tmp(n, value);
+                vector tmp(n, value, data_alloc);
                 swap(tmp);
             }
             else if (n > size())
@@ -45,10 +111,20 @@ namespace STL {
     public:
         //构造函数，复制构造函数，析构函数
         vector() : start(0), finish(0), mem_end(0){};
-        vector(const size_type& n, const value_type& value) ;
+        explicit vector(const allocator_type& a) : start(0), finish(0), mem_end(0), data_alloc(a) {};
+        vector(const size_type& n, const value_type& value, const allocator_type& a = allocator_type()) ;
         explicit vector(const size_type& n);
-        vector(vector& v);
+        template <class InputIterator, class = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+        vector(InputIterator first, InputIterator last, const allocator_type& a = allocator_type());
+        vector(const vector& v);
+        vector(const vector& v, const allocator_type& a);
+        vector(vector&& v) noexcept;
+        vector(vector&& v, const allocator_type& a);
         ~vector();
+        vector& operator =(const vector& v);
+        vector& operator =(vector&& v);
+
+        allocator_type get_allocator() const { return data_alloc; }
 
         //操作符重载
         bool operator ==(vector& v);
@@ -63,6 +139,11 @@ namespace STL {
         size_type capacity();
         bool empty();
         void resize(const size_t& n, value_type value=value_type());
+        /*
+         * 同resize，但新增的元素只做默认初始化：可平凡默认构造的类型不写内存，内容未定，
+         * 用于预先开出马上会被整体覆盖的大缓冲区，省掉一遍无用的置零
+         */
+        void resize_default_init(const size_t& n);
         void reserve(const size_t& n);
         void shrink_yo_fit();
 
@@ -77,140 +158,212 @@ namespace STL {
 
         //元素调整
         void push_back(const value_type& val);
+        void push_back(value_type&& val);
+        template <class... Args>
+        reference emplace_back(Args&&... args);
+        template <class... Args>
+        iterator emplace(iterator position, Args&&... args);
         void pop_back();
         iterator erase(iterator position);
         iterator erase(iterator first, iterator last);
         void insert(iterator position, const size_type& n, const value_type& val);
         iterator insert(iterator position, const value_type& value);
+        iterator insert(iterator position, value_type&& value);
+        //插入[first, last)，返回指向第一个插入元素的迭代器；区间不能来自本容器
+        template <class InputIterator, class = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+        iterator insert(iterator position, InputIterator first, InputIterator last);
+        /*
+         * 把另一个容器(vector、deque、list、unordered_set等，有begin/end即可)的元素追加到末尾
+         * 随机访问迭代器的区间个数可直接算出，容量按扩容策略一次到位再单遍复制；
+         * 节点式容器求个数本身就要遍历一遍，不如直接逐个追加
+         */
+        template <class Range>
+        void append_range(Range&& range) { append_aux(range.begin(), range.end(), iterator_category(range.begin())); }
         void clear();
-        void swap(vector<T>& rhs) noexcept
+        void swap(vector& rhs) noexcept
         {
             if (this != &rhs)
             {
                 STL::swap(start, rhs.start);
                 STL::swap(finish, rhs.finish);
                 STL::swap(mem_end, rhs.mem_end);
+                STL::__alloc_on_swap(data_alloc, rhs.data_alloc);
             }
         }
         void assign(size_type n, const value_type& value)
         { fill_assign(n, value); }
+        template <class InputIterator, class = typename std::enable_if<!std::is_integral<InputIterator>::value>::type>
+        void assign(InputIterator first, InputIterator last)
+        { range_assign(first, last, iterator_category(first)); }
 
     };
     //构造，析构，赋值
-    template<class T, class Alloc>
-    vector<T, Alloc>::~vector() {
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>::~vector() {
         deallocate();
     }
 
-    template<class T, class Alloc>
-    vector<T, Alloc>::vector(const vector::size_type &n) {
-        fill_initialize(n, T());
+    //n个值初始化的元素，不要求T可复制
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>::vector(const vector::size_type &n) : start(0), finish(0), mem_end(0) {
+        if (n == 0) return;
+        start = alloc_traits::allocate(data_alloc, n);
+        finish = mem_end = STL::uninitialized_value_construct_n(start, n);
+    }
+
+
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator, class>
+    vector<T, Alloc, Growth>::vector(InputIterator first, InputIterator last, const allocator_type& a)
+            : start(0), finish(0), mem_end(0), data_alloc(a) {
+        range_init(first, last, iterator_category(first));
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator>
+    void vector<T, Alloc, Growth>::range_init(InputIterator first, InputIterator last, input_iterator_tag) {
+        for (; first != last; ++ first)
+            emplace_back(*first);
     }
 
+    template<class T, class Alloc, class Growth>
+    template<class ForwardIterator>
+    void vector<T, Alloc, Growth>::range_init(ForwardIterator first, ForwardIterator last, forward_iterator_tag) {
+        const size_type n = STL::distance(first, last);
+        if (n == 0) return;
+        const size_type len = round_capacity(n);
+        start = alloc_traits::allocate(data_alloc, len);
+        finish = STL::uninitialized_copy(first, last, start);
+        mem_end = start + len;
+    }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::deallocate() {
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::deallocate() {
         if (start) {
-            data_allocator::destroy(start, finish);
-            data_allocator::deallocate(start, capacity());
+            //按元素类型分派，可平凡析构的元素不遍历
+            alloc_traits::destroy(data_alloc, start, finish);
+            alloc_traits::deallocate(data_alloc, start, capacity());
         }
     }
 
-    template<class T, class Alloc>
-    vector<T, Alloc>::vector(const vector::size_type &n, const value_type &value) {
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>::vector(const vector::size_type &n, const value_type &value, const allocator_type& a)
+            : start(0), finish(0), mem_end(0), data_alloc(a) {
         fill_initialize(n, value);
     }
 
     //空间配置器相关
-    template<class T, class Alloc>
-    void vector<T, Alloc>::fill_initialize(const vector::size_type &n, const T &value) {
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::fill_initialize(const vector::size_type &n, const T &value) {
         start = allocate_and_fill(n, value);
         finish = start + n;
         mem_end = finish;
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::allocate_and_fill(const vector::size_type &n, const T &x) {
-        iterator result = data_allocator::allocate(n);
-        std::uninitialized_fill_n(result, n, x);
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::allocate_and_fill(const vector::size_type &n, const T &x) {
+        iterator result = alloc_traits::allocate(data_alloc, n);
+        STL::uninitialized_fill_n(result, n, x);
         return result;
     }
 
     //大小，容量相关
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::size_type vector<T, Alloc>::capacity() {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::size_type vector<T, Alloc, Growth>::capacity() {
         return mem_end - begin();
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::size_type vector<T, Alloc>::size() {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::size_type vector<T, Alloc, Growth>::size() {
         return end() - begin();
     }
 
-    template<class T, class Alloc>
-    bool vector<T, Alloc>::empty() {
+    template<class T, class Alloc, class Growth>
+    bool vector<T, Alloc, Growth>::empty() {
         return begin() == end();
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::resize(const size_t &n, value_type value) {
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::resize(const size_t &n, value_type value) {
         if (n < size()) {
-            data_allocator ::destroy(start + n, finish);
+            alloc_traits::destroy(data_alloc, start + n, finish);
             finish = start + n;
         }
         else if (n > size() && n <= capacity()) {
             auto needInsertSize = n - size();
-            finish = uninitialized_fill_n(finish, needInsertSize, value);
+            finish = STL::uninitialized_fill_n(finish, needInsertSize, value);
         }
         else {
             auto needInsertSize = n - size();
-            iterator newStart = data_allocator ::allocate(n);
-            iterator newFinish = uninitialized_copy(begin(), end(), newStart);
-            newFinish = uninitialized_fill_n(newFinish, needInsertSize, value);
-
-            deallocate();
+            grow_to(n);
+            finish = STL::uninitialized_fill_n(finish, needInsertSize, value);
+        }
+    }
 
-            start = newStart;
-            finish = newFinish;
-            mem_end = start + n;
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::resize_default_init(const size_t &n) {
+        if (n < size()) {
+            alloc_traits::destroy(data_alloc, start + n, finish);
+            finish = start + n;
+            return;
         }
+        if (n > capacity()) grow_to(n);
+        finish = STL::uninitialized_default_construct_n(finish, n - size());
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::reserve(const size_t &n) {
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::reserve(const size_t &n) {
         if (n <= capacity()) { ///只增不减
             return ;
         }
-        iterator new_start = data_allocator::allocate(n);
-        iterator new_finish = std::uninitialized_copy(begin(), end(), new_start);
+        grow_to(n);
+    }
+
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::grow_to(vector::size_type len) {
+        grow_to(round_capacity(len), std::integral_constant<bool, is_trivially_relocatable<T>::value>());
+    }
+
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::grow_to(const vector::size_type &len, std::true_type) {
+        const size_type old_size = size();
+        start = alloc_traits::reallocate(data_alloc, start, capacity(), len);
+        finish = start + old_size;
+        mem_end = start + len;
+    }
+
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::grow_to(const vector::size_type &len, std::false_type) {
+        iterator new_start = alloc_traits::allocate(data_alloc, len);
+        iterator new_finish = STL::__uninitialized_move_if_noexcept(start, finish, new_start);
         deallocate();
         start = new_start;
         finish = new_finish;
-        mem_end = new_start + n;
+        mem_end = new_start + len;
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::shrink_yo_fit() {
-        iterator new_start = data_allocator::allocate(size());
-        iterator new_finish = uninitialized_copy(start, finish, new_start);
-        deallocate();
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::shrink_yo_fit() {
+        iterator new_start = alloc_traits::allocate(data_alloc, size());
+        iterator new_finish = STL::uninitialized_relocate(start, finish, new_start);
+        if (start) alloc_traits::deallocate(data_alloc, start, capacity()); //旧元素已随搬移结束，只释放空间
         start = new_start;
         finish = new_finish;
         mem_end = new_finish;
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::begin() {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::begin() {
         return start;
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::end() {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::end() {
         return finish;
     }
 
-    template<class T, class Alloc>
-    bool vector<T, Alloc>::operator==(vector &v) {
+    template<class T, class Alloc, class Growth>
+    bool vector<T, Alloc, Growth>::operator==(vector &v) {
         if (v.size() != size()) return false;
         auto p1 = begin();
         auto p2 = v.begin();
@@ -219,72 +372,117 @@ namespace STL {
         return true;
     }
 
-    template<class T, class Alloc>
-    bool vector<T, Alloc>::operator!=(vector &v) {
+    template<class T, class Alloc, class Growth>
+    bool vector<T, Alloc, Growth>::operator!=(vector &v) {
         return (*this == v) == false;
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::reference vector<T, Alloc>::front() {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::front() {
         return *begin();
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::reference vector<T, Alloc>::back() {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::back() {
         return *(end()-1);
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::reference vector<T, Alloc>::operator[](const vector::size_type &n) {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::operator[](const vector::size_type &n) {
         return *(begin() + n);
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::pointer vector<T, Alloc>::data() {
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::pointer vector<T, Alloc, Growth>::data() {
         return begin();
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::push_back(const value_type &val) {
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::push_back(const value_type &val) {
+        if (finish != mem_end) {
+            alloc_traits::construct(data_alloc, finish, val);
+            ++ finish;
+        }
+        else {
+            emplace_aux(finish, val);
+        }
+    }
+
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::push_back(value_type &&val) {
+        emplace_back(std::move(val));
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class... Args>
+    typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::emplace_back(Args&&... args) {
         if (finish != mem_end) {
-            construct(finish, val);
+            alloc_traits::construct(data_alloc, finish, std::forward<Args>(args)...);
             ++ finish;
         }
         else {
-            insert_aux(finish, val);
+            emplace_aux(finish, std::forward<Args>(args)...);
         }
+        return *(finish - 1);
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::pop_back() {
+    template<class T, class Alloc, class Growth>
+    template<class... Args>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::emplace(vector::iterator position, Args&&... args) {
+        auto delta = position - start;
+        emplace_aux(position, std::forward<Args>(args)...);
+        return start + delta;
+    }
+
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::pop_back() {
         --finish;
-        destroy(finish);
+        alloc_traits::destroy(data_alloc, finish);
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::clear() {
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::clear() {
         erase(begin(), end());
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::insert_aux(vector::iterator position, const T &x) {
-        if (finish != mem_end) {    //仍有备用空间
-            construct(finish, *(finish-1));
+    template<class T, class Alloc, class Growth>
+    template<class... Args>
+    void vector<T, Alloc, Growth>::emplace_aux(vector::iterator position, Args&&... args) {
+        if (finish != mem_end && position == finish) { //在尾部插入，直接构造
+            alloc_traits::construct(data_alloc, finish, std::forward<Args>(args)...);
+            ++ finish;
+        }
+        else if (finish != mem_end && is_trivially_relocatable<T>::value) { //仍有备用空间，整段后移一格
+            T x_copy(std::forward<Args>(args)...); //args可能引用容器中的元素，先构造出来再搬动
+            memmove(static_cast<void*>(position + 1), static_cast<void*>(position), (finish - position) * sizeof(T));
             ++ finish;
-            T x_copy = x;
-            copy(position, finish, position + 1);
-            *position = x_copy;
+            alloc_traits::construct(data_alloc, position, std::move(x_copy));
+        }
+        else if (finish != mem_end) {    //仍有备用空间
+            T x_copy(std::forward<Args>(args)...); //args可能引用容器中的元素，先构造出来再搬动
+            alloc_traits::construct(data_alloc, finish, std::move(*(finish-1)));
+            ++ finish;
+            STL::move_backward(position, finish - 2, finish - 1);
+            *position = std::move(x_copy);
+        }
+        else if (is_trivially_relocatable<T>::value) { //无备用空间，可按字节搬移的元素先扩容(realloc)再插入
+            const size_type old_size = size();
+            const size_type index = position - start;
+            T x_copy(std::forward<Args>(args)...); //x可能就是容器中的元素
+            grow_to(Growth::grow(capacity(), old_size + 1));
+            emplace_aux(start + index, std::move(x_copy));
         }
         else { //无备用空间，扩大并重新分配
             const size_type old_size = size();
-            const size_type len = old_size == 0 ? 1 : old_size * 2;
-            iterator new_start = data_allocator::allocate(len); //重新分配
-            iterator new_finish = uninitialized_copy(start, position, new_start); //把position之前的copy
-            construct(new_finish, x);
+            const size_type len = next_capacity(old_size + 1);
+            iterator new_start = alloc_traits::allocate(data_alloc, len); //重新分配
+            //先在新空间构造新元素，此时args引用的旧元素还在原处
+            alloc_traits::construct(data_alloc, new_start + (position - start), std::forward<Args>(args)...);
+            //旧元素能不抛异常地移动就移动，否则复制
+            iterator new_finish = STL::__uninitialized_move_if_noexcept(start, position, new_start);
             ++ new_finish;
-            new_finish = uninitialized_copy(position, finish, new_finish); //把position之后的copy
+            new_finish = STL::__uninitialized_move_if_noexcept(position, finish, new_finish);
 
-            destroy(begin(), end());
             deallocate();
 
             start = new_start;
@@ -295,30 +493,107 @@ namespace STL {
     }
 
 
-    template<class T, class Alloc>
-    vector<T, Alloc>::vector(vector<T, Alloc> & v) {
-        if (v.capacity()) start = data_allocator::allocate(capacity());
-        finish = mem_end = uninitialized_copy(v.begin(), v.end(), start);
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>::vector(const vector<T, Alloc, Growth> & v)
+            : vector(v, alloc_traits::select_on_container_copy_construction(v.data_alloc)) {}
 
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>::vector(const vector<T, Alloc, Growth> & v, const allocator_type& a)
+            : start(0), finish(0), mem_end(0), data_alloc(a) {
+        if (v.finish != v.start) start = alloc_traits::allocate(data_alloc, v.finish - v.start);
+        finish = mem_end = STL::uninitialized_copy(v.start, v.finish, start);
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(vector::iterator position) {
-        copy(position + 1, finish, position);
-        destroy(finish --);
+    //按propagate_on_container_copy_assignment决定用谁的配置器，在临时对象中复制好再交换
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(const vector<T, Alloc, Growth> & v) {
+        if (this != &v) {
+            vector tmp(v, alloc_traits::propagate_on_container_copy_assignment::value ? v.data_alloc : data_alloc);
+            STL::swap(start, tmp.start);
+            STL::swap(finish, tmp.finish);
+            STL::swap(mem_end, tmp.mem_end);
+            STL::swap(data_alloc, tmp.data_alloc);
+        }
+        return *this;
+    }
+
+    //移动构造直接接管v的空间，配置器随之移动
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>::vector(vector<T, Alloc, Growth> && v) noexcept
+            : start(v.start), finish(v.finish), mem_end(v.mem_end), data_alloc(std::move(v.data_alloc)) {
+        v.start = v.finish = v.mem_end = 0;
+    }
+
+    //指定的配置器与v的不相等时不能接管v的空间，只能逐个移动元素
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>::vector(vector<T, Alloc, Growth> && v, const allocator_type& a)
+            : start(0), finish(0), mem_end(0), data_alloc(a) {
+        if (alloc_traits::equal(data_alloc, v.data_alloc)) {
+            STL::swap(start, v.start);
+            STL::swap(finish, v.finish);
+            STL::swap(mem_end, v.mem_end);
+        }
+        else {
+            if (v.finish != v.start) start = alloc_traits::allocate(data_alloc, v.finish - v.start);
+            finish = mem_end = STL::uninitialized_move(v.start, v.finish, start);
+        }
+    }
+
+    /*
+     * propagate_on_container_move_assignment为真或两边配置器相等时直接接管v的空间，
+     * 否则用自己的配置器逐个移动元素
+     */
+    template<class T, class Alloc, class Growth>
+    vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(vector<T, Alloc, Growth> && v) {
+        if (this != &v) {
+            if (alloc_traits::propagate_on_container_move_assignment::value ||
+                alloc_traits::equal(data_alloc, v.data_alloc)) {
+                deallocate();
+                start = v.start;
+                finish = v.finish;
+                mem_end = v.mem_end;
+                v.start = v.finish = v.mem_end = 0;
+                STL::__alloc_on_move(data_alloc, v.data_alloc);
+            }
+            else {
+                vector tmp(std::move(v), data_alloc);
+                STL::swap(start, tmp.start);
+                STL::swap(finish, tmp.finish);
+                STL::swap(mem_end, tmp.mem_end);
+            }
+        }
+        return *this;
+    }
+
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(vector::iterator position) {
+        if (is_trivially_relocatable<T>::value) { //析构被删的元素，后面的整段前移
+            alloc_traits::destroy(data_alloc, position);
+            memmove(static_cast<void*>(position), static_cast<void*>(position + 1), (finish - position - 1) * sizeof(T));
+            -- finish;
+            return position;
+        }
+        STL::move(position + 1, finish, position);
+        alloc_traits::destroy(data_alloc, -- finish);
         return position;
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::erase(vector::iterator first, vector::iterator last) {
-        iterator i = std::copy(last, finish, first);
-        destroy(i, finish);
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(vector::iterator first, vector::iterator last) {
+        if (is_trivially_relocatable<T>::value) {
+            alloc_traits::destroy(data_alloc, first, last);
+            memmove(static_cast<void*>(first), static_cast<void*>(last), (finish - last) * sizeof(T));
+            finish = finish - (last - first);
+            return first;
+        }
+        iterator i = STL::move(last, finish, first);
+        alloc_traits::destroy(data_alloc, i, finish);
         finish = finish - (last - first);
         return  first;
     }
 
-    template<class T, class Alloc>
-    void vector<T, Alloc>::insert(vector::iterator position, const vector::size_type &n, const value_type &val) {
+    template<class T, class Alloc, class Growth>
+    void vector<T, Alloc, Growth>::insert(vector::iterator position, const vector::size_type &n, const value_type &val) {
         if (n != 0) {
             if (size_type(mem_end - finish) >= n) {
                 // 备用空间大于等于“新增元素个数”
@@ -328,38 +603,158 @@ namespace STL {
                 iterator old_finish = finish;
                 if (ele_num > n) {
                     // 插入点后现有元素大于新增元素个数
-                    uninitialized_copy(finish - n, finish, finish);
+                    STL::uninitialized_copy(finish - n, finish, finish);
                     finish += n;
-                    copy_backward(position, old_finish - n, old_finish);
-                    fill(position, position + n, x_copy);
+                    STL::copy_backward(position, old_finish - n, old_finish);
+                    STL::fill(position, position + n, x_copy);
                 }
                 else {
                     //插入点之后的现有元素个数 小于等于 新增元素个数
-                    uninitialized_fill_n(finish, n - ele_num, x_copy);
+                    STL::uninitialized_fill_n(finish, n - ele_num, x_copy);
                     finish += n - ele_num;
-                    uninitialized_copy(position, old_finish, finish);
+                    STL::uninitialized_copy(position, old_finish, finish);
                     finish += ele_num;
-                    fill(position, old_finish, x_copy);
+                    STL::fill(position, old_finish, x_copy);
                 }
 
             }
             else {
-                const size_type old_size = size();
-                const size_type len = old_size + max(old_size, n);
-                iterator new_start = data_allocator::allocate(len);
-                iterator new_finish = new_start;
-                new_finish = uninitialized_copy(start, position, new_start);
-                new_finish = uninitialized_fill_n(new_finish, n, val);
-                new_finish = uninitialized_copy(position, finish, new_finish);
+                const size_type len = next_capacity(size() + n);
+                iterator new_start = alloc_traits::allocate(data_alloc, len);
+                //先填入新元素，val可能引用旧元素
+                STL::uninitialized_fill_n(new_start + (position - start), n, val);
+                iterator new_finish = STL::__uninitialized_move_if_noexcept(start, position, new_start);
+                new_finish = STL::__uninitialized_move_if_noexcept(position, finish, new_finish + n);
+                deallocate();
+                start = new_start;
+                finish = new_finish;
+                mem_end = new_start + len;
             }
         }
     }
 
-    template<class T, class Alloc>
-    typename vector<T, Alloc>::iterator vector<T, Alloc>::insert(vector::iterator position, const value_type &value) {
-        auto delta = position - start;
-        insert_aux(position, value);
-        return start + delta;
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(vector::iterator position, const value_type &value) {
+        return emplace(position, value);
+    }
+
+    template<class T, class Alloc, class Growth>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(vector::iterator position, value_type &&value) {
+        return emplace(position, std::move(value));
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator, class>
+    typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::insert(vector::iterator position,
+                                                                                 InputIterator first, InputIterator last) {
+        const size_type index = position - start;
+        range_insert(position, first, last, iterator_category(first));
+        return start + index;
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator>
+    void vector<T, Alloc, Growth>::append_aux(InputIterator first, InputIterator last, input_iterator_tag) {
+        for (; first != last; ++ first)
+            emplace_back(*first);
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class RandomAccessIterator>
+    void vector<T, Alloc, Growth>::append_aux(RandomAccessIterator first, RandomAccessIterator last,
+                                              random_access_iterator_tag) {
+        const size_type n = last - first;
+        if (size_type(mem_end - finish) < n) grow_to(Growth::grow(capacity(), size() + n));
+        finish = STL::uninitialized_copy(first, last, finish);
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator>
+    void vector<T, Alloc, Growth>::range_insert(vector::iterator position, InputIterator first, InputIterator last,
+                                                input_iterator_tag) {
+        if (position == finish) {
+            for (; first != last; ++ first)
+                emplace_back(*first);
+            return;
+        }
+        for (; first != last; ++ first, ++ position)
+            position = emplace(position, *first);
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class ForwardIterator>
+    void vector<T, Alloc, Growth>::range_insert(vector::iterator position, ForwardIterator first, ForwardIterator last,
+                                                forward_iterator_tag) {
+        const size_type n = STL::distance(first, last);
+        if (n == 0) return;
+        if (size_type(mem_end - finish) >= n) {
+            const size_type ele_num = finish - position; //插入点之后的元素个数
+            iterator old_finish = finish;
+            if (is_trivially_relocatable<T>::value) { //插入点之后整段后移n格，空出来的位置直接构造
+                memmove(static_cast<void*>(position + n), static_cast<void*>(position), ele_num * sizeof(T));
+                STL::uninitialized_copy(first, last, position);
+                finish += n;
+            }
+            else if (ele_num > n) {
+                STL::uninitialized_move(finish - n, finish, finish);
+                finish += n;
+                STL::move_backward(position, old_finish - n, old_finish);
+                STL::copy(first, last, position);
+            }
+            else {
+                ForwardIterator mid = first;
+                STL::advance(mid, ele_num);
+                finish = STL::uninitialized_copy(mid, last, finish);
+                finish = STL::uninitialized_move(position, old_finish, finish);
+                STL::copy(first, mid, position);
+            }
+            return;
+        }
+        const size_type len = next_capacity(size() + n);
+        iterator new_start = alloc_traits::allocate(data_alloc, len);
+        iterator new_finish = STL::uninitialized_copy(first, last, new_start + (position - start));
+        if (is_trivially_relocatable<T>::value) { //旧元素按字节搬过去，只释放旧空间
+            STL::uninitialized_relocate(start, position, new_start);
+            new_finish = STL::uninitialized_relocate(position, finish, new_finish);
+            if (start) alloc_traits::deallocate(data_alloc, start, capacity());
+        }
+        else {
+            STL::__uninitialized_move_if_noexcept(start, position, new_start);
+            new_finish = STL::__uninitialized_move_if_noexcept(position, finish, new_finish);
+            deallocate();
+        }
+        start = new_start;
+        finish = new_finish;
+        mem_end = new_start + len;
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class InputIterator>
+    void vector<T, Alloc, Growth>::range_assign(InputIterator first, InputIterator last, input_iterator_tag) {
+        iterator cur = start;
+        for (; first != last && cur != finish; ++ first, ++ cur)
+            *cur = *first;
+        if (first == last) erase(cur, finish);
+        else range_insert(finish, first, last, input_iterator_tag());
+    }
+
+    template<class T, class Alloc, class Growth>
+    template<class ForwardIterator>
+    void vector<T, Alloc, Growth>::range_assign(ForwardIterator first, ForwardIterator last, forward_iterator_tag) {
+        const size_type n = STL::distance(first, last);
+        if (n > capacity()) {
+            vector tmp(first, last, data_alloc);
+            swap(tmp);
+        }
+        else if (n > size()) {
+            ForwardIterator mid = first;
+            STL::advance(mid, size());
+            STL::copy(first, mid, start);
+            finish = STL::uninitialized_copy(mid, last, finish);
+        }
+        else {
+            erase(STL::copy(first, last, start), finish);
+        }
     }
 
 }
@@ -0,0 +1,167 @@
+#ifndef MY_TINY_STL_WORK_STEALING_DEQUE_H
+#define MY_TINY_STL_WORK_STEALING_DEQUE_H
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include "allocator.h"
+#include "allocator_traits.h"
+
+namespace STL {
+    /*
+     * Chase-Lev无锁工作窃取双端队列(按Lê等人给出的C11内存序实现)
+     * 只有一个所有者线程在底部push/pop，任意多个窃取线程在顶部steal，三者都不加锁
+     * 元素存放在容量为2的幂的环形数组中，满了由所有者换成两倍大的数组；
+     * 窃取线程可能还在读旧数组，所以旧数组先挂起来，析构时统一释放，总量不超过当前数组
+     * 窃取线程会与所有者的写入并发地读取元素，T必须可平凡复制，通常是任务指针或下标
+     * top和bottom按64字节对齐；C++11的new不保证过对齐，放在堆上时要用STL::allocator等按alignof分配
+     */
+    template <class T, class Alloc = allocator<T>>
+    class work_stealing_deque {
+        static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque requires a trivially copyable T");
+    public:
+        typedef T           value_type;
+        typedef size_t      size_type;
+        typedef Alloc       allocator_type;
+
+    private:
+        struct buffer {
+            size_type mask; //容量减一
+            std::atomic<T>* slots;
+            buffer* retired; //被它替换下来的旧数组
+
+            std::atomic<T>& at(ptrdiff_t i) { return slots[size_type(i) & mask]; }
+        };
+        typedef allocator_traits<Alloc> traits;
+        typedef typename traits::template rebind_alloc<buffer> buffer_allocator;
+        typedef typename traits::template rebind_alloc<std::atomic<T>> slot_allocator;
+        typedef allocator_traits<buffer_allocator> buffer_traits;
+        typedef allocator_traits<slot_allocator> slot_traits;
+
+        //top被窃取线程争用，bottom只由所有者写，分开放在不同的缓存行上
+        alignas(64) std::atomic<ptrdiff_t> top;
+        alignas(64) std::atomic<ptrdiff_t> bottom;
+        std::atomic<buffer*> array;
+        buffer_allocator buf_alloc;
+        slot_allocator slot_alloc;
+
+        buffer* new_buffer(size_type capacity, buffer* retired);
+        //把[t, b)搬到两倍大的数组，只由所有者调用
+        buffer* grow(buffer* a, ptrdiff_t t, ptrdiff_t b);
+
+    public:
+        //capacity向上取到2的幂
+        explicit work_stealing_deque(size_type capacity = 64, const allocator_type& a = allocator_type());
+        work_stealing_deque(const work_stealing_deque&) = delete;
+        work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+        ~work_stealing_deque();
+
+        //以下两个只能由所有者线程调用
+        void push(const value_type& val);
+        //取走最近push的元素，队列空时返回false
+        bool pop(value_type& out);
+        //任意线程调用，取走最早push的元素；队列空或与其他线程竞争失败时返回false
+        bool steal(value_type& out);
+
+        //其他线程调用时只是一个近似值
+        size_type size() const;
+        bool empty() const { return size() == 0; }
+        size_type capacity() const { return array.load(std::memory_order_relaxed)->mask + 1; }
+    };
+
+    template<class T, class Alloc>
+    typename work_stealing_deque<T, Alloc>::buffer*
+    work_stealing_deque<T, Alloc>::new_buffer(size_type capacity, buffer* retired) {
+        buffer* a = buffer_traits::allocate(buf_alloc, 1);
+        a->mask = capacity - 1;
+        a->slots = slot_traits::allocate(slot_alloc, capacity);
+        a->retired = retired;
+        return a;
+    }
+
+    template<class T, class Alloc>
+    work_stealing_deque<T, Alloc>::work_stealing_deque(size_type capacity, const allocator_type& a)
+            : top(0), bottom(0), buf_alloc(a), slot_alloc(a) {
+        size_type cap = 1;
+        while (cap < capacity) cap <<= 1;
+        array.store(new_buffer(cap, nullptr), std::memory_order_relaxed);
+    }
+
+    template<class T, class Alloc>
+    work_stealing_deque<T, Alloc>::~work_stealing_deque() {
+        buffer* a = array.load(std::memory_order_relaxed);
+        while (a != nullptr) {
+            buffer* next = a->retired;
+            slot_traits::deallocate(slot_alloc, a->slots, a->mask + 1);
+            buffer_traits::deallocate(buf_alloc, a, 1);
+            a = next;
+        }
+    }
+
+    template<class T, class Alloc>
+    typename work_stealing_deque<T, Alloc>::buffer*
+    work_stealing_deque<T, Alloc>::grow(buffer* a, ptrdiff_t t, ptrdiff_t b) {
+        buffer* na = new_buffer((a->mask + 1) * 2, a);
+        for (ptrdiff_t i = t; i < b; ++ i)
+            na->at(i).store(a->at(i).load(std::memory_order_relaxed), std::memory_order_relaxed);
+        //release：窃取线程看到新数组时也看到搬过去的元素
+        array.store(na, std::memory_order_release);
+        return na;
+    }
+
+    template<class T, class Alloc>
+    void work_stealing_deque<T, Alloc>::push(const value_type &val) {
+        ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+        ptrdiff_t t = top.load(std::memory_order_acquire);
+        buffer* a = array.load(std::memory_order_relaxed);
+        if (b - t > ptrdiff_t(a->mask)) a = grow(a, t, b);
+        a->at(b).store(val, std::memory_order_relaxed);
+        //元素先于新的bottom对窃取线程可见
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    template<class T, class Alloc>
+    bool work_stealing_deque<T, Alloc>::pop(value_type &out) {
+        ptrdiff_t b = bottom.load(std::memory_order_relaxed) - 1;
+        buffer* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        //先占住b再读top，与steal中的fence配对，保证两边不会都拿到最后一个元素
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        ptrdiff_t t = top.load(std::memory_order_relaxed);
+        if (t > b) { //已经空了
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->at(b).load(std::memory_order_relaxed);
+        if (t == b) { //只剩最后一个，和窃取线程抢top
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    template<class T, class Alloc>
+    bool work_stealing_deque<T, Alloc>::steal(value_type &out) {
+        ptrdiff_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        ptrdiff_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) return false;
+        buffer* a = array.load(std::memory_order_acquire);
+        T x = a->at(t).load(std::memory_order_relaxed);
+        //CAS成功才说明读到的x没有被所有者或其他窃取线程取走
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false;
+        out = x;
+        return true;
+    }
+
+    template<class T, class Alloc>
+    typename work_stealing_deque<T, Alloc>::size_type work_stealing_deque<T, Alloc>::size() const {
+        ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+        ptrdiff_t t = top.load(std::memory_order_relaxed);
+        return b > t ? size_type(b - t) : 0;
+    }
+}
+
+#endif //MY_TINY_STL_WORK_STEALING_DEQUE_H